@@ -0,0 +1,52 @@
+#include "../src/arc_flow.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Arc-flow graph sizes before and after Brandao's compression on 288"
+// stock, with lengths on a 1/16" grid, and the LP solve on the compressed
+// graph where it is small enough to finish quickly.
+
+static std::vector<Demand> makeDemand(int distinct, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> sixteenths(6 * 16, 140 * 16);
+    std::vector<Demand> demand;
+    for (int i = 0; i < distinct; ++i) {
+        demand.push_back({ lengthFromInches(sixteenths(rng) / 16.0), 1 + static_cast<long long>(rng() % 40) });
+    }
+    return demand;
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    const Length stockLength = lengthFromInches(288.0);
+    std::printf("%8s %9s %9s %11s %11s %10s %13s %10s %10s\n", "lengths", "nodes", "arcs", "comp nodes",
+                "comp arcs", "build (ms)", "compress (ms)", "lp (ms)", "lp value");
+
+    for (int distinct : { 10, 25, 50, 100, 200 }) {
+        std::vector<Demand> demand = makeDemand(distinct, 11);
+
+        auto start = std::chrono::steady_clock::now();
+        ArcFlowGraph graph = buildArcFlowGraph(demand, stockLength);
+        double buildMs = elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        ArcFlowGraph compressed = compressArcFlowGraph(graph);
+        double compressMs = elapsedMs(start);
+
+        std::printf("%8d %9d %9d %11d %11d %10.1f %13.1f", distinct, graph.nodeCount(), graph.arcCount(),
+                    compressed.nodeCount(), compressed.arcCount(), buildMs, compressMs);
+        if (distinct <= 10) {
+            start = std::chrono::steady_clock::now();
+            ArcFlowResult result = solveArcFlow(demand, stockLength, { 30.0 });
+            std::printf(" %10.1f %10.3f\n", elapsedMs(start), result.lpObjective);
+        } else {
+            std::printf(" %10s %10s\n", "skipped", "-");
+        }
+    }
+    return 0;
+}
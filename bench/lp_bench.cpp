@@ -0,0 +1,110 @@
+#include "../src/lp_solver.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Micro-benchmarks for LpSolver on cutting-stock master problems: one row
+// per distinct length (A x >= d), one column per pattern. Columns arrive one
+// at a time as they would from pricing, and each arrival is followed by a
+// re-solve, either warm from the previous basis or cold from scratch.
+
+struct Instance {
+    std::vector<double> demand;
+    std::vector<std::vector<int>> rowIndex;
+    std::vector<std::vector<double>> value;
+};
+
+// Homogeneous patterns first, then random greedy fills of 288" stock.
+static Instance makeInstance(int rows, int patterns, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> lengthDist(300, 9000);
+    std::vector<int> lengths(rows);
+    Instance instance;
+    for (int i = 0; i < rows; ++i) {
+        lengths[i] = lengthDist(rng);
+        instance.demand.push_back(1 + rng() % 200);
+    }
+
+    const int capacity = 28800;
+    for (int i = 0; i < rows; ++i) {
+        instance.rowIndex.push_back({ i });
+        instance.value.push_back({ static_cast<double>(capacity / lengths[i]) });
+    }
+    while (static_cast<int>(instance.rowIndex.size()) < rows + patterns) {
+        std::vector<int> counts(rows, 0);
+        int left = capacity;
+        for (int tries = 0; tries < 4 * rows; ++tries) {
+            int i = static_cast<int>(rng() % rows);
+            if (lengths[i] <= left) {
+                ++counts[i];
+                left -= lengths[i];
+            }
+        }
+        std::vector<int> index;
+        std::vector<double> value;
+        for (int i = 0; i < rows; ++i) {
+            if (counts[i] == 0) continue;
+            index.push_back(i);
+            value.push_back(counts[i]);
+        }
+        instance.rowIndex.push_back(std::move(index));
+        instance.value.push_back(std::move(value));
+    }
+    return instance;
+}
+
+static LpSolver makeMaster(const Instance& instance, int columns) {
+    LpSolver lp(static_cast<int>(instance.demand.size()));
+    for (int i = 0; i < static_cast<int>(instance.demand.size()); ++i)
+        lp.setRowBounds(i, instance.demand[i], LpSolver::kInfinity);
+    for (int j = 0; j < columns; ++j)
+        lp.addColumn(1.0, 0.0, LpSolver::kInfinity, instance.rowIndex[j], instance.value[j]);
+    return lp;
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    std::printf("%6s %8s %12s %12s %12s %12s %10s\n", "rows", "columns", "warm (ms)", "warm pivots",
+                "cold (ms)", "cold pivots", "objective");
+
+    for (int rows : { 50, 100, 200 }) {
+        const int added = 4 * rows;
+        Instance instance = makeInstance(rows, added, 7);
+        int total = rows + added;
+
+        // Warm: one solver, a column at a time, re-solving after each
+        auto start = std::chrono::steady_clock::now();
+        LpSolver warm = makeMaster(instance, rows);
+        warm.solve();
+        for (int j = rows; j < total; ++j) {
+            warm.addColumn(1.0, 0.0, LpSolver::kInfinity, instance.rowIndex[j], instance.value[j]);
+            warm.solve();
+        }
+        double warmMs = elapsedMs(start);
+
+        // Cold: rebuild and solve from the slack basis at a sample of the
+        // same points, scaled up to the same number of re-solves
+        const int stride = 20;
+        double coldMs = 0.0;
+        long long coldPivots = 0;
+        int samples = 0;
+        for (int j = rows; j <= total; j += stride) {
+            auto coldStart = std::chrono::steady_clock::now();
+            LpSolver cold = makeMaster(instance, j);
+            cold.solve();
+            coldMs += elapsedMs(coldStart);
+            coldPivots += cold.iterations();
+            ++samples;
+        }
+        double scale = static_cast<double>(added + 1) / samples;
+
+        std::printf("%6d %8d %12.1f %12d %12.1f %12lld %10.3f\n", rows, total, warmMs, warm.iterations(),
+                    coldMs * scale, static_cast<long long>(coldPivots * scale), warm.objective());
+    }
+    return 0;
+}
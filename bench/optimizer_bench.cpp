@@ -0,0 +1,98 @@
+#include "../src/optimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+// The first-fit-decreasing loop optimizeCuts used before GroupIndex, kept
+// here as the reference the indexed version is timed and checked against.
+static void legacyOptimizeCuts(const std::vector<Part>& parts, Length stockLength,
+                               std::vector<std::vector<Length>>& result) {
+    std::vector<Length> allParts;
+    for (const auto& part : parts) {
+        for (int i = 0; i < part.quantity; ++i)
+            allParts.push_back(part.length);
+    }
+
+    std::ranges::sort(allParts, std::greater<>());
+
+    for (Length partLen : allParts) {
+        bool placed = false;
+        for (auto& stock : result) {
+            Length used = 0;
+            for (Length p : stock) used += p;
+            if (used + partLen <= stockLength) {
+                stock.push_back(partLen);
+                placed = true;
+                break;
+            }
+        }
+        if (!placed) result.push_back({ partLen });
+    }
+}
+
+// Random order with roughly one distinct length per 50 cuts, lengths in
+// hundredths of an inch between 6" and 140" on 288" stock.
+static std::vector<Part> makeParts(int totalCuts, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> hundredths(600, 14000);
+    std::vector<Part> parts;
+    int remaining = totalCuts;
+    while (remaining > 0) {
+        int qty = std::min(remaining, 1 + static_cast<int>(rng() % 100));
+        parts.push_back({ "P" + std::to_string(parts.size()), hundredths(rng) * kLengthUnitsPerInch / 100, qty, "2 x 2" });
+        remaining -= qty;
+    }
+    return parts;
+}
+
+// Every stock of a plan, sorted, for comparing against the legacy loop
+// (the plan merges identical stocks, so its order differs).
+static std::vector<std::vector<Length>> sortedStocks(const CutPlan& plan) {
+    std::vector<std::vector<Length>> stocks(plan.begin(), plan.end());
+    std::ranges::sort(stocks);
+    return stocks;
+}
+
+template <typename Fn>
+static double timeMs(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    // The legacy loop is quadratic; only run it up to this many cuts.
+    int legacyLimit = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const Length stockLength = lengthFromInches(288.0);
+
+    std::printf("%10s %8s %9s %14s %14s %8s %10s %10s\n", "cuts", "stocks", "patterns", "indexed (ms)",
+                "legacy (ms)", "same", "bfd stocks", "bfd (ms)");
+    for (int cuts : { 10000, 100000, 1000000 }) {
+        std::vector<Part> parts = makeParts(cuts, 42);
+
+        CutPlan indexed;
+        double indexedMs = timeMs([&] { indexed = optimizeCuts(parts, stockLength); });
+
+        CutPlan bestFit;
+        double bestFitMs = timeMs([&] { bestFit = optimizeCuts(parts, stockLength, { Algorithm::BestFitDecreasing }); });
+
+        if (cuts > legacyLimit) {
+            std::printf("%10d %8lld %9zu %14.1f %14s %8s %10lld %10.1f\n", cuts, indexed.stockCount(),
+                        indexed.patterns().size(), indexedMs, "skipped", "-", bestFit.stockCount(), bestFitMs);
+            continue;
+        }
+
+        std::vector<std::vector<Length>> legacy;
+        double legacyMs = timeMs([&] { legacyOptimizeCuts(parts, stockLength, legacy); });
+        std::ranges::sort(legacy);
+        std::printf("%10d %8lld %9zu %14.1f %14.1f %8s %10lld %10.1f\n", cuts, indexed.stockCount(),
+                    indexed.patterns().size(), indexedMs, legacyMs, sortedStocks(indexed) == legacy ? "yes" : "NO",
+                    bestFit.stockCount(), bestFitMs);
+    }
+    return 0;
+}
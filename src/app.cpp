@@ -6,16 +6,44 @@
 #include <string>
 #include <unordered_map>
 #include <algorithm>
+#include <memory>
 #include <GLFW/glfw3.h>
 
 #include "app.h"
 
 #include <ranges>
 
+#include "cut_list.h"
 #include "optimizer.h"
 #include "pdf_export.h"
+#include "portfolio.h"
+#include "project.h"
+#include "thread_pool.h"
 #include "utils.h"
 
+namespace {
+
+// Pattern rows of one dimension's plan for the results preview.
+void drawPlanPreview(const std::string& dim, const CutPlan& plan, int stockLength) {
+    ImGui::Text("Dimension: %s (Stock Length: %d, %s)", dim.c_str(), stockLength, describeStockCount(plan).c_str());
+    if (plan.fixedCuts() > 0) {
+        ImGui::Text("  Reduction fixed %lld cuts before the search", plan.fixedCuts());
+    }
+    const auto& patterns = plan.patterns();
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        std::string cuts = "  Pattern " + patternLabel(i) + " x" + std::to_string(patterns[i].count) + ": ";
+        for (Length len : patterns[i].cuts) {
+            cuts += formatLength(len) + "\" ";
+        }
+        char usedBuf[64];
+        snprintf(usedBuf, sizeof(usedBuf), "(%s / %d)", formatLength(patterns[i].used()).c_str(), stockLength);
+        cuts += usedBuf;
+        ImGui::Text("%s", cuts.c_str());
+    }
+}
+
+} // namespace
+
 void App::run() {
     // GLFW + OpenGL + ImGui setup
     glfwInit();
@@ -35,6 +63,9 @@ void App::run() {
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init(glsl_version);
 
+    // Workers for the optimizer, kept for the life of the app
+    ThreadPool pool;
+
     // App state
     std::vector<Part> parts;
     std::unordered_map<std::string, int> stockLengths; // stock length per dimension
@@ -45,7 +76,8 @@ void App::run() {
     bool showResults = false;
 
     // Optimization results per dimension
-    std::unordered_map<std::string, std::vector<std::vector<double>>> optimizationResults;
+    std::unordered_map<std::string, CutPlan> optimizationResults;
+    std::unique_ptr<Portfolio> job; // running optimization, if any
 
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
@@ -105,7 +137,7 @@ void App::run() {
 
         if (ImGui::Button("Add Part")) {
             if (inputLength > 0 && inputQty > 0) {
-                parts.push_back({ inputNum, inputLength, inputQty, selectedDim });
+                parts.push_back({ inputNum, lengthFromInches(inputLength), inputQty, selectedDim });
                 inputLength = 0.0;
                 inputQty = 0;
                 inputNum[0] = '\0';
@@ -113,6 +145,37 @@ void App::run() {
             }
         }
 
+        // Cut lists exported from a spreadsheet; parsed on the optimizer's
+        // workers, so not while they are busy
+        static char importPath[512] = "";
+        static std::string importStatus;
+        ImGui::InputText("Cut List (CSV/TSV)", importPath, sizeof(importPath));
+        if (!job) {
+            ImGui::SameLine();
+            if (ImGui::Button("Import")) {
+                CutListImport imported;
+                std::string error;
+                if (importCutList(importPath, selectedDim, pool, imported, error)) {
+                    parts.insert(parts.end(), std::make_move_iterator(imported.parts.begin()),
+                                 std::make_move_iterator(imported.parts.end()));
+                    importStatus = "Imported " + std::to_string(imported.rows - imported.badRows) + " rows as " +
+                                   std::to_string(imported.parts.size()) + " parts";
+                    if (imported.badRows > 0) {
+                        importStatus += ", skipped " + std::to_string(imported.badRows) + " bad rows:";
+                        for (const auto& bad : imported.errors) {
+                            importStatus += "\n  line " + std::to_string(bad.line) + ": " + bad.message;
+                        }
+                    }
+                    showResults = false;
+                } else {
+                    importStatus = error;
+                }
+            }
+        }
+        if (!importStatus.empty()) {
+            ImGui::TextWrapped("%s", importStatus.c_str());
+        }
+
         ImGui::NewLine();
         ImGui::Separator();
         ImGui::NewLine();
@@ -124,19 +187,27 @@ void App::run() {
             ImGui::PopStyleColor();
         }
 
-        for (int i = 0; i < static_cast<int>(parts.size()); ++i) {
-            const auto&[part_number, length, quantity, dimension] = parts[i];
-
-            ImGui::Bullet();
-            ImGui::Text("%dx %.2f\" %s (%s)", quantity, length, dimension.c_str(), part_number.c_str());
-            ImGui::SameLine();
-
-            if (ImGui::SmallButton(("Delete##" + std::to_string(i)).c_str())) {
-                parts.erase(parts.begin() + i);
-                showResults = false;
-                break;
+        // Only the visible rows, since an imported list can run to millions
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(parts.size()));
+        bool erased = false;
+        while (!erased && clipper.Step()) {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                const auto&[part_number, length, quantity, dimension] = parts[i];
+
+                ImGui::Bullet();
+                ImGui::Text("%dx %s\" %s (%s)", quantity, formatLength(length).c_str(), dimension.c_str(), part_number.c_str());
+                ImGui::SameLine();
+
+                if (ImGui::SmallButton(("Delete##" + std::to_string(i)).c_str())) {
+                    parts.erase(parts.begin() + i);
+                    showResults = false;
+                    erased = true;
+                    break;
+                }
             }
         }
+        if (erased) clipper.End();
 
         // Cluster parts by dimension & initialize default stock lengths if needed
         std::unordered_map<std::string, std::vector<Part>> partsByDimension;
@@ -166,14 +237,112 @@ void App::run() {
         }
 
         ImGui::NewLine();
-        if (ImGui::Button("Optimize")) {
-            optimizationResults.clear();
-            for (auto& [dim, partGroup] : partsByDimension) {
-                double stockLen = stockLengths[dim];
-                optimizationResults[dim].clear();
-                optimizeCuts(partGroup, stockLen, optimizationResults[dim]);
+        // Arc flow is not offered: its graph has a node per grid step, so the
+        // LP only finishes on a handful of lengths
+        const char* algorithmNames[] = { "First Fit Decreasing", "Best Fit Decreasing", "Column Generation",
+                                         "Branch and Bound (exact)", "Anytime",
+                                         "Portfolio (race all)", "Greedy + Local Search",
+                                         "Grouping Genetic", "Minimum Bin Slack", "Sequential Value Correction" };
+        const Algorithm algorithmChoices[] = { Algorithm::FirstFitDecreasing, Algorithm::BestFitDecreasing,
+                                               Algorithm::ColumnGeneration, Algorithm::BranchAndBound,
+                                               Algorithm::Anytime, Algorithm::Portfolio, Algorithm::LocalSearch,
+                                               Algorithm::Genetic, Algorithm::MinBinSlack,
+                                               Algorithm::ValueCorrection };
+        static_assert(IM_ARRAYSIZE(algorithmNames) == IM_ARRAYSIZE(algorithmChoices));
+        static int currentChoice = 0;
+        static double timeLimit = 10.0;
+        ImGui::Combo("Algorithm", &currentChoice, algorithmNames, IM_ARRAYSIZE(algorithmNames));
+        Algorithm currentAlgorithm = algorithmChoices[currentChoice];
+        if (currentAlgorithm != Algorithm::FirstFitDecreasing && currentAlgorithm != Algorithm::BestFitDecreasing) {
+            if (ImGui::InputDouble("Time Limit (s)", &timeLimit, 1.0, 10.0, "%.1f")) {
+                timeLimit = std::max(0.1, timeLimit);
             }
-            showResults = true;
+        }
+
+        // Projects keep the parts, stock lengths and plans between sessions
+        static char projectPath[512] = "";
+        static std::string projectStatus;
+        ImGui::InputText("Project (.rodun)", projectPath, sizeof(projectPath));
+        if (!job) {
+            std::string error;
+            ImGui::SameLine();
+            if (ImGui::Button("Open")) {
+                Job opened;
+                std::unordered_map<std::string, CutPlan> plans;
+                if (loadProject(projectPath, opened, plans, error)) {
+                    parts = std::move(opened.parts);
+                    stockLengths = std::move(opened.stockLengths);
+                    // Projects saved with an algorithm no longer offered open with the default
+                    auto choice = std::ranges::find(algorithmChoices, opened.options.algorithm);
+                    currentChoice = choice != std::end(algorithmChoices)
+                                        ? static_cast<int>(choice - std::begin(algorithmChoices))
+                                        : 0;
+                    timeLimit = opened.options.timeLimitSeconds;
+                    optimizationResults = std::move(plans);
+                    showResults = !optimizationResults.empty();
+                    projectStatus = "Opened " + std::string(projectPath);
+                } else {
+                    projectStatus = error;
+                }
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Save")) {
+                // Plans are saved only while they match the parts list
+                Job current{ parts, stockLengths, { currentAlgorithm, timeLimit } };
+                std::unordered_map<std::string, CutPlan> noPlans;
+                if (saveProject(projectPath, current, showResults ? optimizationResults : noPlans, error)) {
+                    projectStatus = "Saved " + std::string(projectPath);
+                } else {
+                    projectStatus = error;
+                }
+            }
+        }
+        if (!projectStatus.empty()) {
+            ImGui::TextWrapped("%s", projectStatus.c_str());
+        }
+
+        if (job) {
+            // Keep rendering while the pool works; pick the plans up when done
+            double fraction = job->progress();
+            double elapsed = job->elapsedSeconds();
+            ImGui::ProgressBar(static_cast<float>(fraction), ImVec2(-1, 0));
+            if (fraction > 0.01 && fraction < 1.0) {
+                ImGui::Text("Elapsed: %.1fs  ETA: %.1fs", elapsed, elapsed * (1.0 - fraction) / fraction);
+            } else {
+                ImGui::Text("Elapsed: %.1fs", elapsed);
+            }
+            if (!job->cancelled() && ImGui::Button("Stop")) {
+                job->cancel();
+            }
+
+            // The best plan each dimension's racers have published; no locks taken
+            for (const auto& dim : job->dimensions()) {
+                if (auto best = dim->incumbent.best()) {
+                    drawPlanPreview(dim->name, *best, stockLengths[dim->name]);
+                } else {
+                    ImGui::Text("Dimension: %s (searching...)", dim->name.c_str());
+                }
+            }
+
+            if (job->finished()) {
+                // A stopped job keeps its results if every dimension has a complete plan
+                auto plans = job->results();
+                if (!plans.empty()) {
+                    optimizationResults = std::move(plans);
+                    showResults = true;
+                }
+                job.reset();
+            }
+        } else if (ImGui::Button("Optimize")) {
+            // Race the solvers for every dimension on the pool in the background
+            std::unordered_map<std::string, Length> stockLens;
+            for (const auto& dim : partsByDimension | std::views::keys) {
+                stockLens[dim] = lengthFromInches(stockLengths[dim]);
+            }
+            OptimizeOptions options{ currentAlgorithm, timeLimit };
+            options.searchThreads = 0; // spread the randomized searches over the idle workers
+            job = std::make_unique<Portfolio>(pool, partsByDimension, stockLens, options);
+            showResults = false;
         }
 
         static bool show_pdf_popup = false;
@@ -184,9 +353,10 @@ void App::run() {
             if (ImGui::Button("Generate PDF")) {
                 std::string downloads = getDownloadsPath();
                 savedPath = generateUniqueFilename(downloads, "materials_cuts", ".pdf");
-                generatePDF(optimizationResults, stockLengths, parts, savedPath);
-                show_pdf_popup = true;
-                system(("open \"" + savedPath + "\"").c_str());
+                if (generatePDF(optimizationResults, stockLengths, parts, savedPath)) {
+                    show_pdf_popup = true;
+                    system(("open \"" + savedPath + "\"").c_str());
+                }
             }
 
             if (show_pdf_popup) {
@@ -204,28 +374,14 @@ void App::run() {
             ImGui::Separator();
             ImGui::Text("Optimization Results Preview:");
 
-            int totalStocksUsed = 0;
-            for (auto &stocks: optimizationResults | std::views::values) {
-                totalStocksUsed += static_cast<int>(stocks.size());
-            }
-            ImGui::Text("Total Stocks Used: %d", totalStocksUsed);
-
-            for (auto& [dim, stocks] : optimizationResults) {
-                ImGui::Text("Dimension: %s (Stock Length: %d)", dim.c_str(), stockLengths[dim]);
-                for (size_t i = 0; i < stocks.size(); ++i) {
-                    double used = 0.0;
-                    std::string cuts = "  Stock " + std::to_string(i + 1) + ": ";
-                    for (double len : stocks[i]) {
-                        char buf[32];
-                        snprintf(buf, sizeof(buf), "%.2f\" ", len);
-                        cuts += buf;
-                        used += len;
-                    }
-                    char usedBuf[64];
-                    snprintf(usedBuf, sizeof(usedBuf), "(%.2f / %d)", used, stockLengths[dim]);
-                    cuts += usedBuf;
-                    ImGui::Text("%s", cuts.c_str());
-                }
+            long long totalStocksUsed = 0;
+            for (auto &plan: optimizationResults | std::views::values) {
+                totalStocksUsed += plan.stockCount();
+            }
+            ImGui::Text("Total Stocks Used: %lld", totalStocksUsed);
+
+            for (auto& [dim, plan] : optimizationResults) {
+                drawPlanPreview(dim, plan, stockLengths[dim]);
                 ImGui::NewLine();
             }
         }
@@ -241,6 +397,9 @@ void App::run() {
         glfwSwapBuffers(window);
     }
 
+    // Racers still running point into the job; it stops and waits for them
+    job.reset();
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
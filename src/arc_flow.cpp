@@ -0,0 +1,236 @@
+#include "arc_flow.h"
+#include "lp_solver.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <tuple>
+
+namespace {
+
+constexpr double kFlowEpsilon = 1e-9;
+constexpr int kIterationsPerCheck = 25; // simplex pivots between budget checks
+constexpr long long kStepsPerCheck = 1 << 16; // grid steps between budget checks
+
+bool outOfBudget(const SolveBudget* budget) {
+    return budget && budget->exhausted();
+}
+
+// Nodes renumbered by position, the leftmost being the source and the
+// rightmost the sink; item arcs, then a loss arc from every other node.
+ArcFlowGraph assembleGraph(const ArcFlowGraph& shape, std::vector<long long> positions,
+                           std::vector<std::tuple<long long, long long, int>> itemArcs) {
+    std::ranges::sort(positions);
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    std::ranges::sort(itemArcs);
+    itemArcs.erase(std::unique(itemArcs.begin(), itemArcs.end()), itemArcs.end());
+
+    ArcFlowGraph graph;
+    graph.rows = shape.rows;
+    graph.grid = shape.grid;
+    graph.position = std::move(positions);
+    auto nodeAt = [&](long long position) {
+        return static_cast<int>(std::ranges::lower_bound(graph.position, position) - graph.position.begin());
+    };
+    graph.source = 0;
+    graph.sink = graph.nodeCount() - 1;
+    for (const auto& [tail, head, row] : itemArcs) graph.arcs.push_back({ nodeAt(tail), nodeAt(head), row });
+    for (int node = 0; node < graph.sink; ++node) graph.arcs.push_back({ node, graph.sink, -1 });
+    return graph;
+}
+
+} // namespace
+
+ArcFlowGraph buildArcFlowGraph(const std::vector<Demand>& demand, Length stockLength, const SolveBudget* budget) {
+    ArcFlowGraph shape;
+    for (const auto& item : demand) {
+        if (item.count > 0 && item.length > 0 && item.length <= stockLength) shape.rows.push_back(item);
+    }
+    std::ranges::sort(shape.rows, std::greater<>(), &Demand::length);
+    shape.grid = stockLength;
+    for (const auto& row : shape.rows) shape.grid = std::gcd(shape.grid, row.length);
+    long long capacity = stockLength / shape.grid;
+
+    // reached: some path of longer pieces ends here. chain: fewest pieces of
+    // the current row on a path ending here after them.
+    constexpr long long kUnreached = std::numeric_limits<long long>::max();
+    std::vector<char> reached(capacity + 1, 0);
+    reached[0] = 1;
+    std::vector<long long> chain(capacity + 1);
+    std::vector<std::tuple<long long, long long, int>> itemArcs;
+    for (int i = 0; i < static_cast<int>(shape.rows.size()); ++i) {
+        long long width = shape.rows[i].length / shape.grid;
+        long long most = std::min<long long>(shape.rows[i].count, capacity / width);
+        std::ranges::fill(chain, kUnreached);
+        for (long long p = 0; p + width <= capacity; ++p) {
+            if (p % kStepsPerCheck == 0 && outOfBudget(budget)) return {};
+            long long copies = reached[p] ? 0 : chain[p];
+            if (copies >= most) continue;
+            if (static_cast<long long>(itemArcs.size()) >= kMaxArcFlowArcs) return {};
+            itemArcs.emplace_back(p, p + width, i);
+            chain[p + width] = std::min(chain[p + width], copies + 1);
+        }
+        for (long long p = 0; p <= capacity; ++p) {
+            if (chain[p] != kUnreached) reached[p] = 1;
+        }
+    }
+
+    std::vector<long long> positions = { capacity };
+    for (long long p = 0; p <= capacity; ++p) {
+        if (reached[p]) positions.push_back(p);
+    }
+    return assembleGraph(shape, std::move(positions), std::move(itemArcs));
+}
+
+ArcFlowGraph compressArcFlowGraph(const ArcFlowGraph& graph, const SolveBudget* budget) {
+    if (graph.nodeCount() == 0 || outOfBudget(budget)) return {};
+    long long capacity = graph.position[graph.sink];
+    std::vector<std::vector<int>> outgoing(graph.nodeCount());
+    for (int a = 0; a < graph.arcCount(); ++a) {
+        if (graph.arcs[a].row >= 0) outgoing[graph.arcs[a].tail].push_back(a);
+    }
+
+    // Heads lie to the right of tails, so a right-to-left sweep is topological
+    std::vector<long long> longest(graph.nodeCount(), 0);
+    for (int node = graph.nodeCount() - 1; node >= 0; --node) {
+        if (node % kStepsPerCheck == 0 && outOfBudget(budget)) return {};
+        for (int a : outgoing[node]) {
+            const auto& arc = graph.arcs[a];
+            long long width = graph.rows[arc.row].length / graph.grid;
+            longest[node] = std::max(longest[node], width + longest[arc.head]);
+        }
+    }
+
+    std::vector<long long> positions;
+    for (int node = 0; node < graph.nodeCount(); ++node) positions.push_back(capacity - longest[node]);
+    std::vector<std::tuple<long long, long long, int>> itemArcs;
+    for (const auto& arc : graph.arcs) {
+        if (arc.row >= 0) itemArcs.emplace_back(capacity - longest[arc.tail], capacity - longest[arc.head], arc.row);
+    }
+
+    // The source has the longest path of all, so it stays the leftmost node
+    return assembleGraph(graph, std::move(positions), std::move(itemArcs));
+}
+
+ArcFlowResult solveArcFlow(const std::vector<Demand>& demand, Length stockLength, const ArcFlowOptions& options) {
+    ArcFlowResult result;
+    SolveBudget budget(options.timeLimitSeconds, options.control);
+
+    // Pieces longer than the stock each take a stock of their own
+    long long oversize = 0;
+    for (const auto& item : demand) {
+        if (item.count > 0 && item.length > stockLength) {
+            result.plan.add({ item.length }, item.count);
+            oversize += item.count;
+        }
+    }
+    ArcFlowGraph graph = compressArcFlowGraph(buildArcFlowGraph(demand, stockLength, &budget), &budget);
+    result.nodes = graph.nodeCount();
+    result.arcs = graph.arcCount();
+    result.lowerBound = oversize;
+    result.cancelled = budget.cancelled();
+    if (result.cancelled) return result;
+    if (graph.nodeCount() == 0) {
+        // Out of time or too large to build: first-fit on the pieces that fit
+        std::vector<Demand> fits;
+        for (const auto& item : demand) {
+            if (item.count > 0 && item.length > 0 && item.length <= stockLength) fits.push_back(item);
+        }
+        CutPlan firstFit = packDemand(fits, stockLength);
+        for (const auto& pattern : firstFit.patterns()) result.plan.add(pattern.cuts, pattern.count);
+        result.plan.setLowerBound(result.lowerBound);
+        return result;
+    }
+    int rowCount = static_cast<int>(graph.rows.size());
+    if (rowCount == 0) return result;
+
+    // Flow conservation at every node, demand rows after them, and one
+    // return arc from sink to source that counts the stocks
+    int nodes = graph.nodeCount();
+    LpSolver lp(nodes + rowCount);
+    for (int node = 0; node < nodes; ++node) lp.setRowBounds(node, 0.0, 0.0);
+    for (int i = 0; i < rowCount; ++i)
+        lp.setRowBounds(nodes + i, static_cast<double>(graph.rows[i].count), LpSolver::kInfinity);
+    for (const auto& arc : graph.arcs) {
+        if (arc.row >= 0) {
+            lp.addColumn(0.0, 0.0, LpSolver::kInfinity, { arc.tail, arc.head, nodes + arc.row }, { -1.0, 1.0, 1.0 });
+        } else {
+            lp.addColumn(0.0, 0.0, LpSolver::kInfinity, { arc.tail, arc.head }, { -1.0, 1.0 });
+        }
+    }
+    lp.addColumn(1.0, 0.0, LpSolver::kInfinity, { graph.sink, graph.source }, { -1.0, 1.0 });
+
+    LpSolver::Status status;
+    while ((status = lp.solve(kIterationsPerCheck)) == LpSolver::Status::IterationLimit) {
+        budget.reportProgress();
+        if (budget.exhausted()) break;
+    }
+    result.cancelled = budget.cancelled();
+    if (result.cancelled) return result;
+
+    std::vector<Demand> leftover = graph.rows;
+    if (status == LpSolver::Status::Optimal) {
+        result.provedOptimalLp = true;
+        result.lpObjective = lp.objective();
+        result.lowerBound += static_cast<long long>(std::ceil(result.lpObjective - 1e-6));
+
+        // Peel paths off the flow, each along the arcs carrying the most
+        std::vector<double> flow(graph.arcs.size());
+        std::vector<std::vector<int>> outgoing(nodes);
+        for (int a = 0; a < graph.arcCount(); ++a) {
+            flow[a] = lp.value(a);
+            outgoing[graph.arcs[a].tail].push_back(a);
+        }
+        std::vector<std::pair<double, std::vector<long long>>> paths; // stocks, pieces per row
+        while (true) {
+            std::vector<int> path;
+            double bottleneck = std::numeric_limits<double>::infinity();
+            for (int node = graph.source; node != graph.sink;) {
+                int next = -1;
+                for (int a : outgoing[node]) {
+                    if (flow[a] > kFlowEpsilon && (next < 0 || flow[a] > flow[next])) next = a;
+                }
+                if (next < 0) break;
+                path.push_back(next);
+                bottleneck = std::min(bottleneck, flow[next]);
+                node = graph.arcs[next].head;
+            }
+            if (path.empty() || graph.arcs[path.back()].head != graph.sink) break;
+
+            std::vector<long long> pieces(rowCount, 0);
+            for (int a : path) {
+                flow[a] -= bottleneck;
+                if (graph.arcs[a].row >= 0) ++pieces[graph.arcs[a].row];
+            }
+            paths.emplace_back(bottleneck, std::move(pieces));
+        }
+
+        // Round down, most used patterns first, never cutting more than is needed
+        std::ranges::sort(paths, std::greater<>(), [](const auto& path) { return path.first; });
+        for (const auto& [value, pieces] : paths) {
+            long long copies = static_cast<long long>(std::floor(value + 1e-9));
+            for (int i = 0; i < rowCount && copies > 0; ++i) {
+                if (pieces[i] > 0) copies = std::min(copies, leftover[i].count / pieces[i]);
+            }
+            if (copies <= 0) continue;
+            std::vector<Length> cuts;
+            for (int i = 0; i < rowCount; ++i) {
+                cuts.insert(cuts.end(), pieces[i], leftover[i].length);
+                leftover[i].count -= copies * pieces[i];
+            }
+            result.plan.add(std::move(cuts), copies);
+        }
+    }
+
+    // First-fit decreasing for whatever rounding left, or everything if the
+    // LP ran out of time
+    std::erase_if(leftover, [](const Demand& row) { return row.count <= 0; });
+    if (!leftover.empty()) {
+        CutPlan repaired = packDemand(leftover, stockLength);
+        for (const auto& pattern : repaired.patterns())
+            result.plan.add(pattern.cuts, pattern.count);
+    }
+    result.plan.setLowerBound(result.lowerBound);
+    return result;
+}
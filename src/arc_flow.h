@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include "optimizer.h"
+#include "plan.h"
+#include "solve_control.h"
+
+// Most item arcs a graph may have; lengths to four decimals can put
+// millions of grid steps under every row.
+constexpr long long kMaxArcFlowArcs = 4'000'000;
+
+// Arc-flow model of cutting one stock length (Valerio de Carvalho). Nodes
+// are positions along the stock in grid steps; an item arc cuts one piece
+// of a demand row and a loss arc skips to the end. Each unit of flow from
+// the source to the sink is one stock cut with the pattern along its path.
+struct ArcFlowGraph {
+    struct Arc {
+        int tail;
+        int head;
+        int row; // demand row the arc cuts, or -1 for a loss arc
+    };
+
+    std::vector<long long> position; // per node, in grid steps from the stock start
+    std::vector<Arc> arcs;
+    std::vector<Demand> rows;        // demand rows, longest first
+    long long grid = 1;              // length units per grid step
+    int source = 0;
+    int sink = 0;
+
+    int nodeCount() const { return static_cast<int>(position.size()); }
+    int arcCount() const { return static_cast<int>(arcs.size()); }
+};
+
+// Builds the graph for pieces that fit the stock. Pieces are placed longest
+// first, and a path uses no more pieces of a row than its demand or the
+// stock allows, which leaves one path per pattern instead of one per order
+// of its pieces. Linear in distinct lengths times grid steps. Returns an
+// empty graph (no nodes) if the budget runs out or the graph would pass
+// kMaxArcFlowArcs.
+ArcFlowGraph buildArcFlowGraph(const std::vector<Demand>& demand, Length stockLength,
+                               const SolveBudget* budget = nullptr);
+
+// Brandao's final compression: each node moves right to the stock length
+// minus its longest path to the sink, and nodes landing together merge.
+// Every path still fits the stock, and no pattern is lost. An empty graph,
+// or a budget that runs out, gives an empty graph.
+ArcFlowGraph compressArcFlowGraph(const ArcFlowGraph& graph, const SolveBudget* budget = nullptr);
+
+struct ArcFlowOptions {
+    double timeLimitSeconds = 10.0;
+    SolveControl* control = nullptr;
+};
+
+struct ArcFlowResult {
+    CutPlan plan;
+    long long lowerBound = 0; // rounded-up LP value, once the LP is solved
+    double lpObjective = 0.0;
+    int nodes = 0;            // of the compressed graph
+    int arcs = 0;
+    bool provedOptimalLp = false;
+    bool cancelled = false;
+};
+
+// Solves the LP relaxation of the compressed model with LpSolver, splits
+// the flow into patterns, rounds them down and repairs the rest with
+// first-fit decreasing. If the graph or the LP does not finish in time the
+// plan is the first-fit one.
+ArcFlowResult solveArcFlow(const std::vector<Demand>& demand, Length stockLength, const ArcFlowOptions& options = {});
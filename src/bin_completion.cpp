@@ -0,0 +1,300 @@
+#include "bin_completion.h"
+#include "lower_bounds.h"
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+
+namespace {
+
+// Completions with more sub-multisets than this only get the maximality test
+constexpr long long kMaxDominanceSubsets = 4096;
+// Memory the search may hold. Every stock on the stack keeps the demand it
+// was opened with and all its completions, a count per row each, so the cap
+// is in bytes rather than nodes; reaching it stops the search like the node
+// limit. The nogoods count toward it but stop growing at their own share.
+constexpr size_t kMaxSearchBytes = 128 << 20;
+constexpr size_t kMaxNogoodBytes = 64 << 20;
+constexpr size_t kNogoodOverhead = 64; // hash node and vector header
+
+struct CountsHash {
+    size_t operator()(const std::vector<long long>& counts) const {
+        size_t hash = 1469598103934665603ull;
+        for (long long count : counts) hash = (hash ^ static_cast<size_t>(count)) * 1099511628211ull;
+        return hash;
+    }
+};
+
+struct Completion {
+    std::vector<long long> taken; // pieces of each row, the opening piece included
+    Length used;
+};
+
+// One opened stock on the search stack.
+struct Frame {
+    long long stocks; // stocks filled before this one
+    size_t open;      // row of the piece that opened it
+    std::vector<long long> remaining; // demand when it was opened, the nogood key
+    std::vector<Completion> completions;
+    size_t next = 0; // completions tried so far; the last one is applied
+};
+
+class BinCompletion {
+public:
+    BinCompletion(const std::vector<Demand>& rows, Length capacity, long long best, long long rootBound,
+                  const BinCompletionOptions& options)
+        : capacity(capacity), best(best), rootBound(rootBound), maxNodes(options.maxNodes),
+          budget(options.timeLimitSeconds, options.control) {
+        for (const auto& row : rows) {
+            lengths.push_back(row.length);
+            counts.push_back(row.count);
+        }
+    }
+
+    // Depth-first over stocks with an explicit stack: the search goes one
+    // level deeper per stock opened, and a plan can need more stocks than
+    // any thread stack has frames for.
+    void run() {
+        std::vector<Frame> stack;
+        if (auto root = expand(0)) stack.push_back(std::move(*root));
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            if (frame.next > 0) retract(frame, frame.completions[frame.next - 1]);
+            if (halted || best <= rootBound || frame.next == frame.completions.size()) {
+                close(frame);
+                stack.pop_back();
+                continue;
+            }
+            apply(frame, frame.completions[frame.next++]);
+            long long stocks = frame.stocks + 1;
+            if (auto child = expand(stocks)) stack.push_back(std::move(*child));
+        }
+    }
+
+    bool stopped() const { return halted; }
+    bool cancelled() const { return budget.cancelled(); }
+    long long nodes() const { return nodeCount; }
+    long long bestCount() const { return best; }
+    const std::vector<std::vector<long long>>& bestStocks() const { return bestSolution; }
+
+private:
+    // Takes bytes from the memory cap, or stops the search if they do not fit.
+    bool hold(size_t bytes) {
+        if (heldBytes + bytes > kMaxSearchBytes) halted = true;
+        if (halted) return false;
+        heldBytes += bytes;
+        return true;
+    }
+
+    size_t rowBytes() const { return counts.size() * sizeof(long long) + sizeof(std::vector<long long>); }
+
+    // The remaining-demand copy, the stock's entry in the current plan and
+    // every completion.
+    size_t frameBytes(const Frame& frame) const {
+        return sizeof(Frame) + 2 * rowBytes() + frame.completions.size() * (sizeof(Completion) + rowBytes());
+    }
+
+    bool tick() {
+        if (++nodeCount > maxNodes) halted = true;
+        if (nodeCount % 1024 == 0) {
+            budget.reportProgress();
+            if (budget.exhausted()) halted = true;
+        }
+        return !halted;
+    }
+
+    long long nodeBound() const {
+        std::vector<Demand> left;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            if (counts[i] > 0) left.push_back({ lengths[i], counts[i] });
+        }
+        return quickLowerBound(left, capacity);
+    }
+
+    // Opens a stock for the longest piece left and lists its completions,
+    // or records a finished plan and returns nothing when there is no
+    // branch worth searching.
+    std::optional<Frame> expand(long long stocks) {
+        if (!tick()) return std::nullopt;
+        size_t open = 0;
+        while (open < counts.size() && counts[open] == 0) ++open;
+        if (open == counts.size()) {
+            if (stocks < best) {
+                best = stocks;
+                bestSolution = current;
+            }
+            return std::nullopt;
+        }
+        if (stocks + nodeBound() >= best) return std::nullopt;
+        if (auto known = nogoods.find(counts); known != nogoods.end() && known->second <= stocks) return std::nullopt;
+        if (!hold(sizeof(Frame) + 2 * rowBytes())) return std::nullopt;
+
+        Frame frame{ stocks, open, counts, {} };
+        --counts[open];
+        std::vector<long long> taken(counts.size(), 0);
+        std::vector<Length> available(counts.size() + 1, 0); // total length of the rows from i on
+        for (size_t i = counts.size(); i-- > open;) available[i] = available[i + 1] + counts[i] * lengths[i];
+        enumerate(open, open, capacity - lengths[open], 0, available, taken, frame.completions);
+        std::ranges::sort(frame.completions, std::greater<>(), &Completion::used);
+        return frame;
+    }
+
+    void apply(const Frame& frame, Completion& completion) {
+        for (size_t i = frame.open; i < counts.size(); ++i) counts[i] -= completion.taken[i];
+        completion.taken[frame.open] += 1;
+        current.push_back(completion.taken);
+    }
+
+    void retract(const Frame& frame, Completion& completion) {
+        current.pop_back();
+        completion.taken[frame.open] -= 1;
+        for (size_t i = frame.open; i < counts.size(); ++i) counts[i] += completion.taken[i];
+    }
+
+    // Restores the opening piece and remembers the demand as searched.
+    void close(Frame& frame) {
+        ++counts[frame.open];
+        heldBytes -= frameBytes(frame);
+        if (halted) return;
+        auto known = nogoods.find(frame.remaining);
+        if (known != nogoods.end()) {
+            known->second = std::min(known->second, frame.stocks);
+            return;
+        }
+        size_t bytes = frame.remaining.size() * sizeof(long long) + kNogoodOverhead;
+        if (nogoodBytes + bytes > kMaxNogoodBytes || heldBytes + bytes > kMaxSearchBytes) return;
+        nogoodBytes += bytes;
+        heldBytes += bytes;
+        nogoods.emplace(std::move(frame.remaining), frame.stocks);
+    }
+
+    // Every maximal way to fill `room` from rows at or after `row`. A row
+    // with pieces left out bounds the final slack: it must stay below the
+    // shortest such piece or the stock could take one more.
+    void enumerate(size_t open, size_t row, Length room, Length smallestLeftOut, const std::vector<Length>& available,
+                   std::vector<long long>& taken, std::vector<Completion>& out) {
+        if (halted) return;
+        if (row == counts.size()) {
+            if (!tick()) return;
+            if (undominated(open, taken, room)) {
+                if (!hold(sizeof(Completion) + rowBytes())) return;
+                Length used = capacity - room;
+                out.push_back({ taken, used });
+            }
+            return;
+        }
+        long long most = std::min<long long>(counts[row], room / lengths[row]);
+        for (long long c = most; c >= 0; --c) {
+            taken[row] = c;
+            Length leftOut = c < counts[row] ? lengths[row] : smallestLeftOut;
+            Length after = room - c * lengths[row];
+            // Even every shorter piece cannot bring the slack below the one left out
+            if (leftOut > 0 && after - available[row + 1] >= leftOut) break;
+            enumerate(open, row + 1, after, leftOut, available, taken, out);
+        }
+        taken[row] = 0;
+    }
+
+    // A completion is dominated when a piece left out could replace a
+    // sub-multiset of the companions no longer than it and the stock would
+    // still fit; the empty sub-multiset is the maximality test.
+    bool undominated(size_t open, const std::vector<long long>& taken, Length slack) const {
+        struct Subset {
+            Length sum;
+            long long size;
+        };
+        long long combinations = 1;
+        for (size_t i = open; i < taken.size() && combinations <= kMaxDominanceSubsets; ++i) {
+            combinations *= taken[i] + 1;
+        }
+        std::vector<Subset> subsets = { { 0, 0 } };
+        if (combinations <= kMaxDominanceSubsets) {
+            for (size_t i = open; i < taken.size(); ++i) {
+                size_t existing = subsets.size();
+                for (long long c = 1; c <= taken[i]; ++c) {
+                    for (size_t s = 0; s < existing; ++s) {
+                        subsets.push_back({ subsets[s].sum + c * lengths[i], subsets[s].size + c });
+                    }
+                }
+            }
+        }
+
+        for (size_t i = open; i < counts.size(); ++i) {
+            if (counts[i] - taken[i] <= 0) continue;
+            Length piece = lengths[i];
+            for (const auto& subset : subsets) {
+                bool sameAsPiece = subset.size == 1 && subset.sum == piece;
+                if (subset.sum <= piece && piece <= subset.sum + slack && !sameAsPiece) return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<Length> lengths;
+    std::vector<long long> counts; // pieces still to place, longest row first
+    Length capacity;
+    long long best;
+    long long rootBound;
+    long long maxNodes;
+    long long nodeCount = 0;
+    bool halted = false;
+    SolveBudget budget;
+    std::vector<std::vector<long long>> current;
+    std::vector<std::vector<long long>> bestSolution;
+    std::unordered_map<std::vector<long long>, long long, CountsHash> nogoods; // demand left -> fewest stocks used
+    size_t nogoodBytes = 0;
+    size_t heldBytes = 0; // stack and nogoods, against kMaxSearchBytes
+};
+
+} // namespace
+
+BinCompletionResult solveBinCompletion(const std::vector<Demand>& demand, Length stockLength, const CutPlan& start,
+                                       const BinCompletionOptions& options) {
+    BinCompletionResult result;
+    result.plan = start;
+
+    // Pieces longer than the stock each take a stock of their own
+    std::vector<Demand> rows;
+    long long oversize = 0;
+    for (const auto& item : demand) {
+        if (item.count <= 0 || item.length <= 0) continue;
+        if (item.length > stockLength) {
+            oversize += item.count;
+        } else {
+            rows.push_back(item);
+        }
+    }
+    std::ranges::sort(rows, std::greater<>(), &Demand::length);
+
+    long long rootBound = computeLowerBounds(rows, stockLength).best();
+    long long startCount = start.stockCount() - oversize;
+    result.lowerBound = oversize + rootBound;
+    if (startCount <= rootBound) {
+        result.provedOptimal = true;
+        result.plan.setLowerBound(result.lowerBound);
+        return result;
+    }
+
+    BinCompletion search(rows, stockLength, startCount, rootBound, options);
+    search.run();
+    result.nodes = search.nodes();
+    result.cancelled = search.cancelled();
+    result.timedOut = search.stopped() && !result.cancelled;
+    result.provedOptimal = !search.stopped();
+    if (result.provedOptimal) result.lowerBound = oversize + search.bestCount();
+
+    if (search.bestCount() < startCount) {
+        CutPlan plan;
+        for (const auto& item : demand) {
+            if (item.count > 0 && item.length > stockLength) plan.add({ item.length }, item.count);
+        }
+        for (const auto& stock : search.bestStocks()) {
+            std::vector<Length> cuts;
+            for (size_t i = 0; i < rows.size(); ++i) cuts.insert(cuts.end(), stock[i], rows[i].length);
+            plan.add(std::move(cuts), 1);
+        }
+        result.plan = std::move(plan);
+    }
+    result.plan.setLowerBound(std::max(result.plan.lowerBound(), result.lowerBound));
+    return result;
+}
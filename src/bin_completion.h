@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include "optimizer.h"
+#include "plan.h"
+#include "solve_control.h"
+
+// Most pieces the portfolio and anytime search give bin completion; the
+// search goes a stock deeper per stock in the plan, and larger orders are
+// left to the other solvers. Asked for by name it runs on any order.
+constexpr long long kMaxRacedCompletionPieces = 2000;
+
+struct BinCompletionOptions {
+    double timeLimitSeconds = 10.0;
+    long long maxNodes = 5000000; // search nodes plus completions generated
+    SolveControl* control = nullptr;
+};
+
+struct BinCompletionResult {
+    CutPlan plan;
+    long long lowerBound = 0; // equals the plan's stock count once proved optimal
+    long long nodes = 0;
+    bool provedOptimal = false;
+    bool timedOut = false; // the time or node limit stopped the search
+    bool cancelled = false;
+};
+
+// Korf's bin completion. The longest piece left opens a stock, which is
+// filled with each undominated completion in turn, fullest first: a
+// completion is dominated when some piece left out could replace pieces in
+// it and still fit. Branches are cut with L2 against the best plan so far,
+// and remaining demands already searched without beating it are kept as
+// nogoods. `start` must be a complete plan for the demand; it is returned
+// when the limits stop the search before anything better is found. Besides
+// the node and time limits, the search stops once the stocks it has open
+// and their completions would take more than a fixed memory cap.
+BinCompletionResult solveBinCompletion(const std::vector<Demand>& demand, Length stockLength, const CutPlan& start,
+                                       const BinCompletionOptions& options = {});
@@ -0,0 +1,250 @@
+#include "cli.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "job.h"
+#include "pdf_export.h"
+#include "project.h"
+#include "server.h"
+#include "thread_pool.h"
+
+namespace {
+
+struct CliOptions {
+    std::vector<std::string> jobs;
+    std::string outDir; // empty: next to each job file
+    bool writePdf = false;
+    bool writePlan = false;
+    bool writeProject = false;
+    bool haveAlgorithm = false; // flags override the job file
+    Algorithm algorithm = Algorithm::FirstFitDecreasing;
+    double timeLimit = 0; // 0: the job file's
+    unsigned threads = 0;
+};
+
+void printUsage(FILE* out, const std::string& program) {
+    std::fprintf(out,
+                 "usage: %s batch [options] JOB...\n"
+                 "       %s serve [--socket PATH] [--threads N]\n"
+                 "\n"
+                 "Optimizes each job file and writes its cutting plan. Without --pdf,\n"
+                 "--plan or --project the plans go to standard output as tab-separated\n"
+                 "rows. A JOB ending in .rodun is a saved project; its plans are used as\n"
+                 "they are unless --algorithm or --time-limit asks for a new solve.\n"
+                 "\n"
+                 "  --algorithm NAME   override the job's algorithm (%s)\n"
+                 "  --time-limit SEC   override the job's time limit\n"
+                 "  --threads N        solver threads, 0 for one per core (default)\n"
+                 "  --out DIR          write outputs here instead of next to each job\n"
+                 "  --pdf              write JOB.pdf\n"
+                 "  --plan             write JOB.plan.tsv\n"
+                 "  --project          write JOB.rodun, the job and its plans\n"
+                 "\n"
+                 "serve keeps the solver warm and answers jobs sent over a Unix domain\n"
+                 "socket (default /tmp/rodun.sock) until interrupted; see server.h.\n",
+                 program.c_str(), program.c_str(), algorithmNames().c_str());
+}
+
+// A --threads value: a whole non-negative number.
+bool parseThreads(const std::string& text, unsigned& threads) {
+    int value = 0;
+    if (!parseInt(text, value) || value < 0) return false;
+    threads = static_cast<unsigned>(value);
+    return true;
+}
+
+bool parseArgs(int argc, char** argv, CliOptions& options) {
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        if (arg == "--pdf") {
+            options.writePdf = true;
+        } else if (arg == "--plan") {
+            options.writePlan = true;
+        } else if (arg == "--project") {
+            options.writeProject = true;
+        } else if (arg == "--algorithm") {
+            const char* name = value();
+            if (!name || !algorithmFromName(name, options.algorithm)) return false;
+            options.haveAlgorithm = true;
+        } else if (arg == "--time-limit") {
+            const char* seconds = value();
+            if (!seconds || !parseDouble(seconds, options.timeLimit) || options.timeLimit <= 0) return false;
+        } else if (arg == "--threads") {
+            const char* threads = value();
+            if (!threads || !parseThreads(threads, options.threads)) return false;
+        } else if (arg == "--out") {
+            const char* dir = value();
+            if (!dir) return false;
+            options.outDir = dir;
+        } else if (arg.starts_with("--")) {
+            return false;
+        } else {
+            options.jobs.push_back(arg);
+        }
+    }
+    return !options.jobs.empty();
+}
+
+bool parseServeArgs(int argc, char** argv, ServerOptions& options) {
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[++i] : nullptr;
+        if (!value) return false;
+        if (arg == "--socket") {
+            options.socketPath = value;
+        } else if (arg == "--threads") {
+            if (!parseThreads(value, options.threads)) return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Writes the plan table to STEM.plan.tsv for --plan, or to stdout when no
+// output file was asked for.
+bool writeTable(const std::string& table, const std::filesystem::path& stem, const CliOptions& cli) {
+    if (cli.writePlan) {
+        std::string planPath = stem.string() + ".plan.tsv";
+        std::ofstream out(planPath, std::ios::binary);
+        out << table;
+        if (!out) {
+            std::fprintf(stderr, "%s: cannot write\n", planPath.c_str());
+            return false;
+        }
+    } else if (!cli.writePdf && !cli.writeProject) {
+        std::fwrite(table.data(), 1, table.size(), stdout);
+    }
+    return true;
+}
+
+void printSummary(const std::string& path, size_t dimensions, long long stocks, long long bound,
+                  std::chrono::steady_clock::time_point started) {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::fprintf(stderr, "%s: %zu dimensions, %lld stocks (lower bound %lld), %.3fs\n", path.c_str(), dimensions,
+                 stocks, bound, seconds);
+}
+
+// Writes the table of a project planned in full straight from the mapping.
+bool writePlannedProject(const ProjectView& view, const std::string& path, const std::filesystem::path& stem,
+                         const CliOptions& cli, std::chrono::steady_clock::time_point started) {
+    if (!writeTable(formatPlanTable(view), stem, cli)) return false;
+    size_t dimensions = 0;
+    long long stocks = 0;
+    long long bound = 0;
+    for (const auto& dim : view.dimensions()) {
+        if (!dim.planned) continue;
+        ++dimensions;
+        for (const auto& pattern : view.patterns(dim)) stocks += pattern.count;
+        bound += dim.lowerBound;
+    }
+    printSummary(path, dimensions, stocks, bound, started);
+    return true;
+}
+
+// Runs one job on the pool and writes what was asked for. False on failure,
+// with the reason already printed.
+bool runJob(const std::string& path, const CliOptions& cli, ThreadPool& pool) {
+    auto started = std::chrono::steady_clock::now();
+    namespace fs = std::filesystem;
+    fs::path base = cli.outDir.empty() ? fs::path(path).parent_path() : fs::path(cli.outDir);
+    fs::path stem = base / fs::path(path).stem();
+    bool project = fs::path(path).extension() == ".rodun";
+    bool resolve = cli.haveAlgorithm || cli.timeLimit > 0;
+    std::string error;
+
+    // Printing a saved plan needs neither the job nor the plans loaded
+    if (project && !resolve && !cli.writePdf && !cli.writeProject) {
+        ProjectView view;
+        if (!view.open(path, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return false;
+        }
+        if (view.planned()) return writePlannedProject(view, path, stem, cli, started);
+    }
+
+    Job job;
+    std::unordered_map<std::string, CutPlan> plans;
+    if (!(project ? loadProject(path, job, plans, error) : readJob(path, job, error))) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return false;
+    }
+    if (cli.haveAlgorithm) job.options.algorithm = cli.algorithm;
+    if (cli.timeLimit > 0) job.options.timeLimitSeconds = cli.timeLimit;
+    auto unplanned = [&] {
+        return std::ranges::find_if(job.parts, [&](const Part& part) { return !plans.contains(part.dimension); });
+    };
+    if (unplanned() != job.parts.end() || resolve) plans = solveJob(job, pool);
+    if (auto part = unplanned(); part != job.parts.end()) {
+        std::fprintf(stderr, "%s: no plan for dimension %s\n", path.c_str(), part->dimension.c_str());
+        return false;
+    }
+
+    if (!writeTable(formatPlanTable(plans, job.stockLengths), stem, cli)) return false;
+    if (cli.writePdf) {
+        std::string pdfPath = stem.string() + ".pdf";
+        if (!generatePDF(plans, job.stockLengths, job.parts, pdfPath)) {
+            std::fprintf(stderr, "%s: cannot write\n", pdfPath.c_str());
+            return false;
+        }
+    }
+    if (cli.writeProject && !saveProject(stem.string() + ".rodun", job, plans, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return false;
+    }
+
+    long long stocks = 0;
+    long long bound = 0;
+    for (const auto& [dim, plan] : plans) {
+        stocks += plan.stockCount();
+        bound += plan.lowerBound();
+    }
+    printSummary(path, plans.size(), stocks, bound, started);
+    return true;
+}
+
+} // namespace
+
+bool isCliCommand(int argc, char** argv) {
+    if (argc < 2) return false;
+    for (const char* command : { "batch", "serve", "--help", "-h" }) {
+        if (std::strcmp(argv[1], command) == 0) return true;
+    }
+    return false;
+}
+
+int runCli(int argc, char** argv) {
+    CliOptions options;
+    std::string program = std::filesystem::path(argv[0]).filename().string();
+    if (argc > 1 && (std::strcmp(argv[1], "--help") == 0 || std::strcmp(argv[1], "-h") == 0)) {
+        printUsage(stdout, program);
+        return 0;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "serve") == 0) {
+        ServerOptions server;
+        if (!parseServeArgs(argc, argv, server)) {
+            printUsage(stderr, program);
+            return 2;
+        }
+        return runServer(server);
+    }
+    if (argc < 2 || std::strcmp(argv[1], "batch") != 0 || !parseArgs(argc, argv, options)) {
+        printUsage(stderr, program);
+        return 2;
+    }
+
+    // One pool for the whole batch, so workers start once
+    ThreadPool pool(options.threads);
+    bool allOk = true;
+    for (const auto& path : options.jobs) {
+        if (!runJob(path, options, pool)) allOk = false;
+    }
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+// Headless entry point: `Rodun batch [options] JOB...` (or rodun-cli) optimizes each job
+// file in turn and writes its plan and PDF without touching GLFW, ImGui or
+// OpenGL. Returns the process exit code: 0 when every job succeeded, 1 when
+// any failed, 2 for a usage error. `serve` runs the socket server instead.
+int runCli(int argc, char** argv);
+
+// Whether the arguments name a command runCli knows: batch, serve or help.
+// The app opens its window for anything else, such as the -psn_ argument
+// or document paths a desktop launcher may pass.
+bool isCliCommand(int argc, char** argv);
@@ -0,0 +1,6 @@
+#include "cli.h"
+
+// The headless build has no window to fall back to.
+int main(int argc, char** argv) {
+    return runCli(argc, argv);
+}
@@ -0,0 +1,262 @@
+#include "column_generation.h"
+#include "knapsack.h"
+#include "lp_solver.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+
+namespace {
+
+constexpr double kEpsilon = 1e-9;
+
+// Most memory one pricing DP may take. Lengths to four decimals put the
+// capacity grid at single units, where the bit per chunk and capacity grows
+// past what a solve should ever hold.
+constexpr double kMaxPricingBytes = 256.0 * (1 << 20);
+constexpr size_t kChunksPerCheck = 16; // pricing passes between budget checks
+
+struct Pattern {
+    std::vector<long long> counts; // pieces of each demand row
+};
+
+// Bytes priceBestPattern needs when every row has a positive dual: a value
+// per capacity step plus a bit per power-of-two chunk and step.
+double pricingBytes(const std::vector<long long>& weights, const std::vector<long long>& maxCopies,
+                    long long capacity) {
+    double chunks = 0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        for (long long left = std::min(maxCopies[i], capacity / weights[i]); left > 0; left >>= 1) ++chunks;
+    }
+    double width = static_cast<double>(capacity) + 1;
+    return width * sizeof(double) + chunks * std::ceil(width / 64) * sizeof(uint64_t);
+}
+
+// Bounded knapsack over the capacity grid: the pattern with the highest
+// total dual value. Each row is split into power-of-two chunks so the DP is
+// a sequence of 0/1 passes, with one bit per chunk and capacity to recover
+// the chosen chunks. Negative if the budget ran out between passes.
+double priceBestPattern(const std::vector<long long>& weights, const std::vector<long long>& maxCopies,
+                        const std::vector<double>& duals, long long capacity, const SolveBudget& budget,
+                        Pattern& best) {
+    struct Chunk {
+        int row;
+        long long copies;
+        long long weight;
+        double value;
+    };
+    std::vector<Chunk> chunks;
+    for (int i = 0; i < static_cast<int>(weights.size()); ++i) {
+        if (duals[i] <= kEpsilon) continue;
+        long long left = std::min(maxCopies[i], capacity / weights[i]);
+        for (long long k = 1; left > 0; k *= 2) {
+            long long copies = std::min(k, left);
+            chunks.push_back({ i, copies, copies * weights[i], copies * duals[i] });
+            left -= copies;
+        }
+    }
+
+    size_t width = static_cast<size_t>(capacity) + 1;
+    size_t words = (width + 63) / 64;
+    std::vector<double> value(width, 0.0);
+    std::vector<uint64_t> taken(chunks.size() * words, 0);
+
+    for (size_t j = 0; j < chunks.size(); ++j) {
+        if (j % kChunksPerCheck == kChunksPerCheck - 1 && budget.exhausted()) return -1.0;
+        knapsackPass(value.data(), taken.data() + j * words, capacity, chunks[j].weight, chunks[j].value, kEpsilon);
+    }
+
+    best.counts.assign(weights.size(), 0);
+    long long c = capacity;
+    for (size_t j = chunks.size(); j-- > 0;) {
+        if (taken[j * words + c / 64] >> (c % 64) & 1) {
+            best.counts[chunks[j].row] += chunks[j].copies;
+            c -= chunks[j].weight;
+        }
+    }
+    return value[capacity];
+}
+
+// Adds a pattern to the restricted master LP as a column with cost one
+// stock: min 1'x s.t. A x >= d, x >= 0.
+void addPatternColumn(LpSolver& master, const Pattern& pattern) {
+    std::vector<int> rowIndex;
+    std::vector<double> value;
+    for (int i = 0; i < static_cast<int>(pattern.counts.size()); ++i) {
+        if (pattern.counts[i] == 0) continue;
+        rowIndex.push_back(i);
+        value.push_back(static_cast<double>(pattern.counts[i]));
+    }
+    master.addColumn(1.0, 0.0, LpSolver::kInfinity, rowIndex, value);
+}
+
+struct MasterSolution {
+    std::vector<Pattern> patterns;
+    std::vector<double> values;
+    double objective = 0.0;
+    double farleyBound = 0.0; // objective / best pricing value, valid every round
+    bool optimal = false;
+    int iterations = 0;
+};
+
+MasterSolution solveMaster(const std::vector<long long>& weights, const std::vector<long long>& demand,
+                           long long capacity, const SolveBudget& budget, int maxIterations) {
+    MasterSolution solution;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        Pattern homogeneous;
+        homogeneous.counts.assign(weights.size(), 0);
+        homogeneous.counts[i] = std::min(demand[i], capacity / weights[i]);
+        solution.patterns.push_back(std::move(homogeneous));
+    }
+
+    // One homogeneous pattern per row makes the master feasible
+    LpSolver master(static_cast<int>(demand.size()));
+    for (int i = 0; i < static_cast<int>(demand.size()); ++i)
+        master.setRowBounds(i, static_cast<double>(demand[i]), LpSolver::kInfinity);
+    for (const auto& pattern : solution.patterns) addPatternColumn(master, pattern);
+
+    while (true) {
+        // Each re-solve starts from the previous basis
+        if (master.solve() != LpSolver::Status::Optimal) break;
+        solution.objective = master.objective();
+
+        Pattern candidate;
+        double value = priceBestPattern(weights, demand, master.duals(), capacity, budget, candidate);
+        if (value < 0) break;
+        if (value > kEpsilon)
+            solution.farleyBound = std::max(solution.farleyBound, solution.objective / std::max(1.0, value));
+        if (value <= 1.0 + 1e-7) {
+            solution.optimal = true;
+            solution.farleyBound = std::max(solution.farleyBound, solution.objective);
+            break;
+        }
+        budget.reportProgress();
+        if (++solution.iterations >= maxIterations || budget.exhausted()) break;
+
+        addPatternColumn(master, candidate);
+        solution.patterns.push_back(std::move(candidate));
+    }
+    for (int j = 0; j < master.columns(); ++j) solution.values.push_back(master.value(j));
+    return solution;
+}
+
+// Pieces of each row the plan still has to cut, in demand order.
+std::vector<Length> patternCuts(const Pattern& pattern, const std::vector<Demand>& rows) {
+    std::vector<Length> cuts;
+    for (size_t i = 0; i < rows.size(); ++i)
+        cuts.insert(cuts.end(), pattern.counts[i], rows[i].length);
+    return cuts;
+}
+
+} // namespace
+
+ColumnGenerationResult solveColumnGeneration(const std::vector<Demand>& demand, Length stockLength,
+                                             const ColumnGenerationOptions& options) {
+    ColumnGenerationResult result;
+    SolveBudget budget(options.timeLimitSeconds, options.control);
+
+    // Pieces longer than the stock each take a stock of their own
+    long long capacity = stockLength;
+    std::vector<Demand> rows;
+    std::vector<long long> weights;
+    long long oversize = 0;
+    for (const auto& item : demand) {
+        if (item.count <= 0) continue;
+        long long weight = item.length;
+        if (weight > capacity || weight <= 0) {
+            result.plan.add({ item.length }, item.count);
+            oversize += item.count;
+            continue;
+        }
+        rows.push_back(item);
+        weights.push_back(weight);
+    }
+    result.lowerBound = oversize;
+    if (rows.empty()) return result;
+
+    // First-fit on the same rows is the plan to beat: rounding a master LP
+    // the budget cut short can come out worse, and is then dropped
+    CutPlan fallback = result.plan;
+    CutPlan firstFit = packDemand(rows, stockLength);
+    for (const auto& pattern : firstFit.patterns()) fallback.add(pattern.cuts, pattern.count);
+
+    // Price on the coarsest grid the lengths allow, e.g. 1/16" steps of
+    // 625 units when every length is a sixteenth
+    long long grid = capacity;
+    for (long long weight : weights) grid = std::gcd(grid, weight);
+    for (long long& weight : weights) weight /= grid;
+    capacity /= grid;
+
+    std::vector<long long> residual;
+    for (const auto& row : rows) residual.push_back(row.count);
+    if (pricingBytes(weights, residual, capacity) > kMaxPricingBytes) {
+        result.plan = std::move(fallback);
+        result.plan.setLowerBound(result.lowerBound);
+        return result;
+    }
+
+    bool first = true;
+    while (!budget.exhausted()) {
+        std::vector<int> active;
+        std::vector<long long> activeWeights, activeDemand;
+        for (int i = 0; i < static_cast<int>(rows.size()); ++i) {
+            if (residual[i] <= 0) continue;
+            active.push_back(i);
+            activeWeights.push_back(weights[i]);
+            activeDemand.push_back(residual[i]);
+        }
+        if (active.empty()) break;
+
+        MasterSolution master = solveMaster(activeWeights, activeDemand, capacity, budget, options.maxIterations);
+        result.iterations += master.iterations;
+        if (first) {
+            result.lpObjective = master.objective;
+            result.provedOptimalLp = master.optimal;
+            result.lowerBound += static_cast<long long>(std::ceil(master.farleyBound - 1e-6));
+            first = false;
+        }
+
+        // Round down, largest values first, never cutting more than is still needed
+        std::vector<size_t> order(master.patterns.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::sort(order, std::greater<>(), [&](size_t p) { return master.values[p]; });
+
+        bool progress = false;
+        for (size_t p : order) {
+            long long copies = static_cast<long long>(std::floor(master.values[p] + 1e-9));
+            for (size_t k = 0; k < active.size() && copies > 0; ++k) {
+                long long perStock = master.patterns[p].counts[k];
+                if (perStock > 0) copies = std::min(copies, residual[active[k]] / perStock);
+            }
+            if (copies <= 0) continue;
+
+            Pattern full;
+            full.counts.assign(rows.size(), 0);
+            for (size_t k = 0; k < active.size(); ++k) {
+                full.counts[active[k]] = master.patterns[p].counts[k];
+                residual[active[k]] -= copies * master.patterns[p].counts[k];
+            }
+            result.plan.add(patternCuts(full, rows), copies);
+            progress = true;
+        }
+        if (!progress) break;
+    }
+    result.timedOut = budget.timedOut();
+    result.cancelled = budget.cancelled();
+    if (result.cancelled) return result;
+
+    // Repair whatever rounding left over with first-fit decreasing
+    std::vector<Demand> leftover;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (residual[i] > 0) leftover.push_back({ rows[i].length, residual[i] });
+    }
+    if (!leftover.empty()) {
+        CutPlan repaired = packDemand(leftover, stockLength);
+        for (const auto& pattern : repaired.patterns())
+            result.plan.add(pattern.cuts, pattern.count);
+    }
+
+    if (fallback.stockCount() < result.plan.stockCount()) result.plan = std::move(fallback);
+    result.plan.setLowerBound(result.lowerBound);
+    return result;
+}
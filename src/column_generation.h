@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+#include "optimizer.h"
+#include "plan.h"
+#include "solve_control.h"
+
+struct ColumnGenerationOptions {
+    double timeLimitSeconds = 10.0;
+    int maxIterations = 2000; // pricing rounds per master solve
+    SolveControl* control = nullptr;
+};
+
+struct ColumnGenerationResult {
+    CutPlan plan;
+    long long lowerBound = 0; // no plan can use fewer stocks
+    double lpObjective = 0.0; // master LP value of the last full solve
+    int iterations = 0;
+    bool provedOptimalLp = false; // pricing found no improving pattern
+    bool timedOut = false;
+    bool cancelled = false; // the plan is incomplete
+};
+
+// Gilmore-Gomory column generation. A restricted master LP over cutting
+// patterns is priced with a bounded knapsack until no pattern improves it,
+// and the fractional solution is rounded down, re-solved on the residual
+// demand, and finally repaired with first-fit decreasing. The result never
+// uses more stocks than first-fit decreasing on the same demand, which is
+// also what it returns when the pricing DP would not fit in memory.
+ColumnGenerationResult solveColumnGeneration(const std::vector<Demand>& demand, Length stockLength,
+                                             const ColumnGenerationOptions& options = {});
@@ -0,0 +1,388 @@
+#include "cut_list.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <string_view>
+#include "mapped_file.h"
+
+namespace {
+
+enum Column { kLengthColumn, kQuantityColumn, kPartNumberColumn, kDimensionColumn, kColumnCount };
+
+struct ColumnName {
+    const char* name;
+    Column column;
+};
+
+// Header names after normalizeName
+constexpr ColumnName kColumnNames[] = {
+    { "length", kLengthColumn },         { "len", kLengthColumn },
+    { "quantity", kQuantityColumn },     { "qty", kQuantityColumn },
+    { "count", kQuantityColumn },        { "partnumber", kPartNumberColumn },
+    { "part", kPartNumberColumn },       { "number", kPartNumberColumn },
+    { "pn", kPartNumberColumn },         { "dimension", kDimensionColumn },
+    { "dim", kDimensionColumn },         { "material", kDimensionColumn },
+    { "size", kDimensionColumn },
+};
+
+// Chunks smaller than this cost more to schedule than to parse
+constexpr size_t kMinChunkBytes = 256 << 10;
+
+struct Layout {
+    char delimiter = ',';
+    int index[kColumnCount] = { -1, -1, -1, -1 };
+    int fieldsNeeded = 0; // one past the rightmost column we read
+};
+
+struct Field {
+    std::string_view text;
+    bool escaped = false; // quoted, with "" still to turn into "
+};
+
+// Rows merge when all three match. Views point into the mapped file or a
+// chunk's unescaped strings, both alive until the import returns.
+struct RowKey {
+    std::string_view partNumber;
+    std::string_view dimension;
+    Length length;
+
+    bool operator==(const RowKey&) const = default;
+};
+
+uint64_t hashRow(const RowKey& key) {
+    uint64_t h = std::hash<std::string_view>()(key.partNumber);
+    h = (h ^ std::hash<std::string_view>()(key.dimension)) * 0x9e3779b97f4a7c15ull;
+    h = (h ^ static_cast<uint64_t>(key.length)) * 0xff51afd7ed558ccdull;
+    return h ^ (h >> 32);
+}
+
+struct Row {
+    RowKey key;
+    uint64_t hash;
+    long long quantity; // zero once merged into an earlier row
+};
+
+// Open-addressing set of rows by key. Millions of distinct parts would mean
+// millions of node allocations in std::unordered_map; this is one flat
+// array whose slots carry part of the hash, so a probe only touches a row
+// that likely matches.
+class RowIndex {
+public:
+    // The row already indexed with row's key, or null after indexing row.
+    Row* findOrAdd(Row& row) {
+        if ((rows.size() + 1) * 2 > slots.size()) grow();
+        size_t mask = slots.size() - 1;
+        uint64_t tag = row.hash & kTagMask;
+        for (size_t i = row.hash & mask;; i = (i + 1) & mask) {
+            uint64_t slot = slots[i];
+            if (slot == 0) {
+                rows.push_back(&row);
+                slots[i] = tag | rows.size();
+                return nullptr;
+            }
+            Row* other = rows[(slot & ~kTagMask) - 1];
+            if ((slot & kTagMask) == tag && other->key == row.key) return other;
+        }
+    }
+
+private:
+    static constexpr uint64_t kTagMask = 0xffffffffull << 32;
+
+    void grow() {
+        slots.assign(std::max<size_t>(1024, slots.size() * 2), 0);
+        size_t mask = slots.size() - 1;
+        for (size_t r = 0; r < rows.size(); ++r) {
+            size_t i = rows[r]->hash & mask;
+            while (slots[i] != 0) i = (i + 1) & mask;
+            slots[i] = (rows[r]->hash & kTagMask) | (r + 1);
+        }
+    }
+
+    std::vector<uint64_t> slots; // hash tag in the high half, position in rows + 1 in the low; 0 is empty
+    std::vector<Row*> rows;
+};
+
+struct Chunk {
+    const char* begin;
+    const char* end;
+    size_t lines = 0;
+    size_t rows = 0;
+    size_t badRows = 0;
+    std::vector<Row> parsed; // good rows in file order
+    std::vector<CutListError> errors; // line numbers within the chunk
+    std::deque<std::string> unescaped;
+    size_t firstPart = 0; // where this chunk's parts start in the result
+    const Row* tooMany = nullptr; // a merged row over INT_MAX pieces
+};
+
+std::string normalizeName(std::string_view name) {
+    std::string normal;
+    for (char c : name) {
+        if (c != ' ' && c != '_' && c != '-' && c != '\r') {
+            normal += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    return normal;
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) text.remove_suffix(1);
+    return text;
+}
+
+// Splits a line into at most maxFields fields. False on an unclosed quote.
+bool splitLine(std::string_view line, char delimiter, size_t maxFields, std::vector<Field>& fields) {
+    fields.clear();
+    size_t i = 0;
+    while (fields.size() < maxFields) {
+        Field& field = fields.emplace_back();
+        while (i < line.size() && line[i] == ' ') ++i;
+        if (i < line.size() && line[i] == '"') {
+            size_t start = ++i;
+            while (true) {
+                size_t quote = line.find('"', i);
+                if (quote == std::string_view::npos) return false;
+                if (quote + 1 < line.size() && line[quote + 1] == '"') {
+                    field.escaped = true;
+                    i = quote + 2;
+                    continue;
+                }
+                field.text = line.substr(start, quote - start);
+                i = quote + 1;
+                break;
+            }
+            size_t next = line.find(delimiter, i);
+            i = next == std::string_view::npos ? line.size() + 1 : next + 1;
+        } else {
+            size_t next = line.find(delimiter, i);
+            size_t stop = next == std::string_view::npos ? line.size() : next;
+            field.text = trim(line.substr(i, stop - i));
+            i = stop + 1;
+        }
+        if (i > line.size()) break;
+    }
+    return true;
+}
+
+// Decimal inches straight to Length, rounding the fifth decimal like
+// lengthFromInches but without going through floating point. Lengths past
+// kMaxPartLength are rejected, as in job files.
+bool parseLength(std::string_view text, Length& length) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    Length whole = 0;
+    if (p < end && *p == '-') return false;
+    if (p < end && *p != '.') {
+        auto [next, ec] = std::from_chars(p, end, whole);
+        if (ec != std::errc() || whole < 0 || whole > kMaxPartLength / kLengthUnitsPerInch) return false;
+        p = next;
+    }
+    Length fraction = 0;
+    if (p < end && *p == '.') {
+        ++p;
+        const char* digits = p;
+        Length scale = kLengthUnitsPerInch;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+            if (scale > 1) {
+                scale /= 10;
+                fraction += (*p - '0') * scale;
+            } else if (p == digits + 4 && *p >= '5') {
+                ++fraction;
+            }
+        }
+        if (p == digits && text.size() == 1) return false;
+    }
+    length = whole * kLengthUnitsPerInch + fraction;
+    return p == end && !text.empty() && length > 0 && length <= kMaxPartLength;
+}
+
+bool parseQuantity(std::string_view text, int& quantity) {
+    auto [next, ec] = std::from_chars(text.data(), text.data() + text.size(), quantity);
+    return ec == std::errc() && next == text.data() + text.size() && quantity > 0;
+}
+
+std::string_view fieldText(const Field& field, Chunk& chunk) {
+    if (!field.escaped) return field.text;
+    std::string& text = chunk.unescaped.emplace_back();
+    for (size_t i = 0; i < field.text.size(); ++i) {
+        text += field.text[i];
+        if (field.text[i] == '"') ++i; // the second quote of ""
+    }
+    return text;
+}
+
+bool readHeader(std::string_view line, Layout& layout, std::string& missing) {
+    layout.delimiter = line.find('\t') != std::string_view::npos ? '\t'
+                       : line.find(';') != std::string_view::npos ? ';'
+                                                                  : ',';
+    std::vector<Field> fields;
+    splitLine(line, layout.delimiter, SIZE_MAX, fields);
+    for (size_t i = 0; i < fields.size(); ++i) {
+        std::string name = normalizeName(fields[i].text);
+        for (const auto& entry : kColumnNames) {
+            if (name == entry.name && layout.index[entry.column] < 0) {
+                layout.index[entry.column] = static_cast<int>(i);
+                layout.fieldsNeeded = std::max(layout.fieldsNeeded, static_cast<int>(i) + 1);
+            }
+        }
+    }
+    if (layout.index[kLengthColumn] < 0) missing = "length";
+    else if (layout.index[kQuantityColumn] < 0) missing = "quantity";
+    return missing.empty();
+}
+
+void parseChunk(Chunk& chunk, const Layout& layout, std::string_view defaultDimension) {
+    std::vector<Field> fields;
+    auto reject = [&](const std::string& message) {
+        ++chunk.badRows;
+        if (chunk.errors.size() < kMaxCutListErrors) chunk.errors.push_back({ chunk.lines, message });
+    };
+    auto column = [&](Column c) -> std::string_view {
+        int i = layout.index[c];
+        return i >= 0 && i < static_cast<int>(fields.size()) ? fieldText(fields[i], chunk) : std::string_view();
+    };
+
+    for (const char* p = chunk.begin; p < chunk.end;) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', chunk.end - p));
+        const char* stop = newline ? newline : chunk.end;
+        std::string_view line(p, stop - p);
+        p = stop + 1;
+        ++chunk.lines;
+
+        if (!splitLine(line, layout.delimiter, layout.fieldsNeeded, fields)) {
+            ++chunk.rows;
+            reject("unclosed quote");
+            continue;
+        }
+        std::string_view lengthText = column(kLengthColumn);
+        std::string_view quantityText = column(kQuantityColumn);
+        std::string_view partNumber = column(kPartNumberColumn);
+        std::string_view dimension = column(kDimensionColumn);
+        if (lengthText.empty() && quantityText.empty() && partNumber.empty() && dimension.empty()) continue;
+        ++chunk.rows;
+
+        Length length = 0;
+        int quantity = 0;
+        if (!parseLength(lengthText, length)) {
+            reject("bad length '" + std::string(lengthText) + "'");
+            continue;
+        }
+        if (!parseQuantity(quantityText, quantity)) {
+            reject("bad quantity '" + std::string(quantityText) + "'");
+            continue;
+        }
+        RowKey key{ partNumber, dimension.empty() ? defaultDimension : dimension, length };
+        chunk.parsed.push_back({ key, hashRow(key), quantity });
+    }
+}
+
+// Merges the rows whose hash falls in this shard: the first row with a key
+// takes the quantity of every later one, which drops to zero. Shards own
+// disjoint keys, so they run side by side without locks, and each one's
+// index holds only its share of the distinct parts.
+void mergeShard(std::vector<Chunk>& chunks, size_t shard, size_t shards) {
+    RowIndex index;
+    for (auto& chunk : chunks) {
+        for (Row& row : chunk.parsed) {
+            if ((row.hash >> 32) * shards >> 32 != shard) continue;
+            if (Row* first = index.findOrAdd(row)) {
+                first->quantity += row.quantity;
+                row.quantity = 0;
+            }
+        }
+    }
+}
+
+// Runs fn(0) ... fn(count - 1) on the pool and waits for all of them.
+template <typename Fn>
+void runTasks(ThreadPool& pool, size_t count, Fn fn) {
+    std::vector<std::future<void>> done;
+    for (size_t i = 0; i < count; ++i) done.push_back(pool.submit([&fn, i] { fn(i); }));
+    for (auto& task : done) task.get();
+}
+
+} // namespace
+
+bool importCutList(const std::string& path, const std::string& defaultDimension, ThreadPool& pool,
+                   CutListImport& result, std::string& error) {
+    result = {};
+    MappedFile file;
+    if (!file.open(path, error)) return false;
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+    if (file.size() >= 3 && std::string_view(begin, 3) == "\xEF\xBB\xBF") begin += 3; // UTF-8 byte order mark
+
+    if (begin == end) {
+        error = path + ": empty file";
+        return false;
+    }
+
+    const char* headerEnd = std::find(begin, end, '\n');
+    Layout layout;
+    std::string missing;
+    if (!readHeader(std::string_view(begin, headerEnd - begin), layout, missing)) {
+        error = path + ":1: no " + missing + " column in the header";
+        return false;
+    }
+
+    // Chunks end just after a newline, so no row straddles two
+    const char* data = headerEnd < end ? headerEnd + 1 : end;
+    size_t bytes = end - data;
+    size_t chunkCount = std::clamp<size_t>(bytes / kMinChunkBytes, 1, size_t{ pool.size() } * 4);
+    std::vector<Chunk> chunks;
+    for (size_t i = 0; i < chunkCount; ++i) {
+        const char* stop = i + 1 == chunkCount ? end : data + bytes * (i + 1) / chunkCount;
+        const char* from = chunks.empty() ? data : chunks.back().end;
+        if (stop < from) stop = from;
+        stop = std::find(stop, end, '\n');
+        if (stop < end) ++stop;
+        if (stop == from) continue;
+        Chunk& chunk = chunks.emplace_back();
+        chunk.begin = from;
+        chunk.end = stop;
+    }
+
+    runTasks(pool, chunks.size(), [&](size_t c) { parseChunk(chunks[c], layout, defaultDimension); });
+    runTasks(pool, pool.size(), [&](size_t shard) { mergeShard(chunks, shard, pool.size()); });
+
+    // Rows still holding a quantity become parts, in file order
+    size_t lineOffset = 1; // the header
+    size_t partCount = 0;
+    for (auto& chunk : chunks) {
+        result.rows += chunk.rows;
+        result.badRows += chunk.badRows;
+        for (auto& bad : chunk.errors) {
+            if (result.errors.size() == kMaxCutListErrors) break;
+            result.errors.push_back({ bad.line + lineOffset, std::move(bad.message) });
+        }
+        lineOffset += chunk.lines;
+        chunk.firstPart = partCount;
+        partCount += std::ranges::count_if(chunk.parsed, [](const Row& row) { return row.quantity > 0; });
+    }
+    result.parts.resize(partCount);
+    runTasks(pool, chunks.size(), [&](size_t c) {
+        Part* part = result.parts.data() + chunks[c].firstPart;
+        for (const Row& row : chunks[c].parsed) {
+            if (row.quantity == 0) continue;
+            if (row.quantity > INT_MAX) chunks[c].tooMany = &row;
+            *part++ = { std::string(row.key.partNumber), row.key.length, static_cast<int>(row.quantity),
+                        std::string(row.key.dimension) };
+        }
+    });
+
+    for (const auto& chunk : chunks) {
+        if (chunk.tooMany) {
+            error = path + ": part " + std::string(chunk.tooMany->key.partNumber) + " needs more than " +
+                    std::to_string(INT_MAX) + " pieces";
+            result = {};
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "optimizer.h"
+#include "thread_pool.h"
+
+// A row of a cut list that was skipped, by 1-based line number.
+struct CutListError {
+    size_t line;
+    std::string message;
+};
+
+struct CutListImport {
+    std::vector<Part> parts; // rows with the same part number, dimension and length merged, in file order
+    size_t rows = 0; // data rows read, good and bad
+    size_t badRows = 0;
+    std::vector<CutListError> errors; // the first kMaxCutListErrors bad rows, by line
+};
+
+constexpr size_t kMaxCutListErrors = 100;
+
+// Imports a CSV or TSV cut list exported from a spreadsheet. The first line
+// names the columns; the delimiter is a tab if the header has one, else a
+// semicolon if it has one, else a comma. Columns are matched by name,
+// ignoring case, spaces and underscores:
+//
+//     length      length in decimal inches (also "len"), at most kMaxPartInches
+//     quantity    pieces needed (also "qty", "count")
+//     part number optional (also "part", "number", "pn")
+//     dimension   optional (also "dim", "material", "size"); defaultDimension when absent or empty
+//
+// Other columns are ignored. Fields may be double-quoted, with "" for a
+// quote, but not span lines. The file is memory-mapped and its chunks
+// parsed on the pool. Bad rows are skipped and reported; returns false,
+// with error set, only if the file cannot be read or lacks a length or
+// quantity column.
+bool importCutList(const std::string& path, const std::string& defaultDimension, ThreadPool& pool,
+                   CutListImport& result, std::string& error);
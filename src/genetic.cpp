@@ -0,0 +1,400 @@
+#include "genetic.h"
+#include "random.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <thread>
+
+namespace {
+
+// Every chromosome of one generation. Chromosome c owns genes[c*n, (c+1)*n),
+// its piece indices grouped by stock, and ends[c*n + k] is one past the
+// last gene of its stock k.
+class Population {
+public:
+    Population(size_t size, size_t pieces)
+        : n(pieces), geneArena(size * pieces), endArena(size * pieces), stockCounts(size), scores(size) {}
+
+    size_t size() const { return stockCounts.size(); }
+
+    int* genes(size_t c) { return geneArena.data() + c * n; }
+    int* ends(size_t c) { return endArena.data() + c * n; }
+    int stocks(size_t c) const { return stockCounts[c]; }
+    double fitness(size_t c) const { return scores[c]; }
+
+    void setScore(size_t c, int stocks, double fitness) {
+        stockCounts[c] = stocks;
+        scores[c] = fitness;
+    }
+
+    std::span<const int> stock(size_t c, int k) const {
+        const int* end = endArena.data() + c * n;
+        const int* genes = geneArena.data() + c * n;
+        return { genes + (k > 0 ? end[k - 1] : 0), genes + end[k] };
+    }
+
+    void copy(size_t to, const Population& from, size_t c) {
+        std::copy_n(from.geneArena.data() + c * n, n, genes(to));
+        std::copy_n(from.endArena.data() + c * n, from.stocks(c), ends(to));
+        setScore(to, from.stocks(c), from.fitness(c));
+    }
+
+private:
+    size_t n;
+    std::vector<int> geneArena;
+    std::vector<int> endArena;
+    std::vector<int> stockCounts;
+    std::vector<double> scores;
+};
+
+// Used length of every stock slot in a min segment tree, so the leftmost
+// stock a piece fits in is one descent. Slots past the last one opened
+// read as empty, which makes opening a new stock the same query; a
+// dissolved stock is marked full so nothing lands in it again.
+class FirstFitIndex {
+public:
+    FirstFitIndex(size_t slots, Length stockLength)
+        : leaves(std::bit_ceil(std::max<size_t>(slots, 1))), stockLength(stockLength), tree(2 * leaves) {}
+
+    void clear() { std::fill(tree.begin(), tree.end(), 0); }
+
+    // Sets a slot without updating the tree; call build() before querying.
+    void preset(int slot, Length used) { tree[leaves + slot] = used; }
+
+    void build() {
+        for (size_t i = leaves - 1; i > 0; --i) tree[i] = std::min(tree[2 * i], tree[2 * i + 1]);
+    }
+
+    Length used(int slot) const { return tree[leaves + slot]; }
+
+    void set(int slot, Length used) {
+        size_t i = leaves + slot;
+        tree[i] = used;
+        for (i /= 2; i > 0; i /= 2) tree[i] = std::min(tree[2 * i], tree[2 * i + 1]);
+    }
+
+    void close(int slot) { set(slot, stockLength); }
+
+    // Expects len in (0, stockLength] and at least one slot never opened.
+    int firstFit(Length len) const {
+        size_t i = 1;
+        while (i < leaves) i = tree[2 * i] + len <= stockLength ? 2 * i : 2 * i + 1;
+        return static_cast<int>(i - leaves);
+    }
+
+private:
+    size_t leaves;
+    Length stockLength;
+    std::vector<Length> tree;
+};
+
+// Scratch for building one child at a time. Each worker owns one, so a
+// generation allocates nothing once the first has run.
+class Builder {
+public:
+    Builder(const std::vector<Length>& lengths, Length stockLength)
+        : lengths(&lengths), stockLength(stockLength), index(maxSlots(lengths.size()), stockLength),
+          stockOf(lengths.size()), inSection(lengths.size()), pieceCount(maxSlots(lengths.size())),
+          cursor(maxSlots(lengths.size())) {
+        freed.reserve(lengths.size());
+    }
+
+    // The given stocks as they are; pieces in none of them are reinserted.
+    void seed(const std::vector<std::vector<int>>& stocks) {
+        begin();
+        for (const auto& stock : stocks) keep(stock);
+        for (size_t piece = 0; piece < stockOf.size(); ++piece) {
+            if (stockOf[piece] < 0) freed.push_back(static_cast<int>(piece));
+        }
+    }
+
+    // Parent a with a run of parent b's stocks inserted at a random point.
+    // Stocks of a that share a piece with the run are dropped and their
+    // other pieces freed.
+    void cross(const Population& parents, size_t a, size_t b, Random& rng) {
+        begin();
+        int bStocks = parents.stocks(b);
+        int first = static_cast<int>(rng.below(bStocks));
+        int run = 1 + static_cast<int>(rng.below(std::min(bStocks - first, std::max(1, bStocks / 4))));
+        for (int k = first; k < first + run; ++k) {
+            for (int piece : parents.stock(b, k)) inSection[piece] = 1;
+        }
+
+        int aStocks = parents.stocks(a);
+        int at = static_cast<int>(rng.below(aStocks + 1));
+        for (int k = 0; k <= aStocks; ++k) {
+            if (k == at) {
+                for (int j = first; j < first + run; ++j) keep(parents.stock(b, j));
+            }
+            if (k == aStocks) break;
+            auto stock = parents.stock(a, k);
+            if (std::ranges::none_of(stock, [&](int piece) { return inSection[piece] != 0; })) {
+                keep(stock);
+                continue;
+            }
+            for (int piece : stock) {
+                if (!inSection[piece]) freed.push_back(piece);
+            }
+        }
+
+        for (int k = first; k < first + run; ++k) {
+            for (int piece : parents.stock(b, k)) inSection[piece] = 0;
+        }
+    }
+
+    // Dissolves up to count stocks, each the emptiest of a small random sample.
+    void mutate(Random& rng, int count) {
+        index.build();
+        for (int i = 0; i < count && liveStocks > 1; ++i) {
+            int victim = -1;
+            for (int sample = 0; sample < 3; ++sample) {
+                int slot = randomLiveSlot(rng);
+                if (victim < 0 || index.used(slot) < index.used(victim)) victim = slot;
+            }
+            pieceCount[victim] = 0;
+            index.close(victim);
+            --liveStocks;
+        }
+        for (size_t piece = 0; piece < stockOf.size(); ++piece) {
+            if (stockOf[piece] < 0 || pieceCount[stockOf[piece]] > 0) continue;
+            stockOf[piece] = -1;
+            freed.push_back(static_cast<int>(piece));
+        }
+    }
+
+    // Reinserts the freed pieces longest first, with neighbours swapped at
+    // odds of one in swapOdds (0 for never), and writes the child to slot c
+    // of out.
+    void finish(Population& out, size_t c, Random& rng, unsigned swapOdds) {
+        const std::vector<Length>& len = *lengths;
+        index.build();
+        std::ranges::sort(freed); // pieces are numbered longest first
+        for (size_t i = 0; i + 1 < freed.size(); ++i) {
+            if (swapOdds > 0 && rng.oneIn(swapOdds)) std::swap(freed[i], freed[i + 1]);
+        }
+        for (int piece : freed) {
+            int slot = index.firstFit(len[piece]);
+            if (slot >= slots) {
+                slot = slots++;
+                ++liveStocks;
+            }
+            stockOf[piece] = slot;
+            ++pieceCount[slot];
+            index.set(slot, index.used(slot) + len[piece]);
+        }
+
+        // Number the live stocks in order and lay their pieces out
+        int* ends = out.ends(c);
+        int stocks = 0;
+        int offset = 0;
+        double fitness = 0;
+        for (int slot = 0; slot < slots; ++slot) {
+            if (pieceCount[slot] == 0) continue;
+            cursor[slot] = offset;
+            offset += pieceCount[slot];
+            ends[stocks++] = offset;
+            double fill = static_cast<double>(index.used(slot)) / static_cast<double>(stockLength);
+            fitness += fill * fill;
+        }
+        int* genes = out.genes(c);
+        for (size_t piece = 0; piece < stockOf.size(); ++piece) genes[cursor[stockOf[piece]]++] = static_cast<int>(piece);
+        out.setScore(c, stocks, fitness);
+    }
+
+private:
+    // Slots are never reused within a child: at most one per piece kept or
+    // opened, one per stock dissolved, and one left unopened for the index.
+    static size_t maxSlots(size_t pieces) { return 2 * pieces + 1; }
+
+    void begin() {
+        std::fill(pieceCount.begin(), pieceCount.begin() + slots, 0);
+        std::ranges::fill(stockOf, -1);
+        index.clear();
+        freed.clear();
+        slots = 0;
+        liveStocks = 0;
+    }
+
+    void keep(std::span<const int> stock) {
+        Length used = 0;
+        for (int piece : stock) {
+            stockOf[piece] = slots;
+            used += (*lengths)[piece];
+        }
+        pieceCount[slots] = static_cast<int>(stock.size());
+        index.preset(slots++, used);
+        ++liveStocks;
+    }
+
+    int randomLiveSlot(Random& rng) {
+        // Most slots are live unless a large share was just dissolved
+        while (true) {
+            int slot = static_cast<int>(rng.below(slots));
+            if (pieceCount[slot] > 0) return slot;
+        }
+    }
+
+    const std::vector<Length>* lengths; // longest first
+    Length stockLength;
+    FirstFitIndex index;
+    std::vector<int> stockOf; // slot of each piece, -1 while freed
+    std::vector<char> inSection;
+    std::vector<int> pieceCount; // per slot; 0 once dissolved
+    std::vector<int> cursor;
+    std::vector<int> freed;
+    int slots = 0;
+    int liveStocks = 0;
+};
+
+unsigned long long childSeed(unsigned long long seed, long long generation, size_t child) {
+    return (seed * 1000003 + static_cast<unsigned long long>(generation)) * 1000003 + child;
+}
+
+} // namespace
+
+GeneticResult solveGrouping(const std::vector<Demand>& demand, Length stockLength, const CutPlan& start,
+                            const GeneticOptions& options) {
+    GeneticResult result;
+    result.plan = start;
+    SolveBudget budget(options.timeLimitSeconds, options.control);
+
+    // Pieces longer than the stock each take a stock of their own; the rest
+    // are counted before any is expanded, since the population cap may rule
+    // the search out
+    CutPlan oversize;
+    long long pieces = 0;
+    for (const auto& item : demand) {
+        if (item.count <= 0 || item.length <= 0) continue;
+        if (item.length > stockLength) {
+            oversize.add({ item.length }, item.count);
+        } else {
+            pieces += item.count;
+        }
+    }
+    long long bound = options.lowerBound - oversize.stockCount();
+    long long bestStocks = start.stockCount() - oversize.stockCount();
+    if (pieces == 0 || bestStocks <= bound) return result;
+    int population = static_cast<int>(std::min<long long>(options.population, kMaxGeneticGenes / pieces));
+    if (population < 4) return result;
+    result.population = population;
+    if (budget.exhausted()) {
+        result.cancelled = budget.cancelled();
+        return result;
+    }
+
+    // Pieces are numbered longest first
+    std::vector<Length> lengths;
+    lengths.reserve(static_cast<size_t>(pieces));
+    for (const auto& item : demand) {
+        if (item.count > 0 && item.length > 0 && item.length <= stockLength) {
+            lengths.insert(lengths.end(), item.count, item.length);
+        }
+    }
+    std::ranges::sort(lengths, std::greater<>());
+    size_t n = lengths.size();
+
+    // The start plan's stocks as piece indices
+    std::map<Length, int> nextPiece;
+    for (size_t i = n; i-- > 0;) nextPiece[lengths[i]] = static_cast<int>(i);
+    std::vector<std::vector<int>> startStocks;
+    for (const auto& cuts : start) {
+        std::vector<int> stock;
+        for (Length len : cuts) {
+            auto it = nextPiece.find(len);
+            if (it != nextPiece.end() && it->second < static_cast<int>(n) && lengths[it->second] == len) {
+                stock.push_back(it->second++);
+            }
+        }
+        if (!stock.empty()) startStocks.push_back(std::move(stock));
+    }
+
+    auto toPlan = [&](const Population& pop, size_t c) {
+        CutPlan plan = oversize;
+        for (int k = 0; k < pop.stocks(c); ++k) {
+            std::vector<Length> cuts;
+            for (int piece : pop.stock(c, k)) cuts.push_back(lengths[piece]);
+            plan.add(std::move(cuts), 1);
+        }
+        plan.setLowerBound(start.lowerBound());
+        return plan;
+    };
+
+    // One block of chromosomes per thread, run on the caller's pool, on a
+    // pool of the solve's own when there is none, or inline for one thread
+    unsigned threads = options.threads > 0 ? static_cast<unsigned>(options.threads)
+            : options.pool ? options.pool->size() : std::max(1u, std::thread::hardware_concurrency());
+    std::optional<ThreadPool> ownPool;
+    ThreadPool* workers = options.pool;
+    if (!workers && threads > 1) workers = &ownPool.emplace(threads - 1); // the calling thread is the last
+    std::vector<Builder> builders(threads, Builder(lengths, stockLength));
+    Population current(population, n);
+    Population next(population, n);
+
+    // Runs make(builder, c) for every chromosome
+    auto generate = [&](auto&& make) {
+        auto block = [&](size_t b) {
+            size_t from = population * b / builders.size();
+            size_t to = population * (b + 1) / builders.size();
+            for (size_t c = from; c < to; ++c) make(builders[b], c);
+        };
+        if (workers) {
+            workers->parallelFor(builders.size(), block);
+        } else {
+            block(0);
+        }
+    };
+
+    // First generation: the start plan, then copies with a random share of
+    // their stocks dissolved and reinserted
+    generate([&](Builder& builder, size_t c) {
+        Random rng(childSeed(options.seed, 0, c));
+        builder.seed(startStocks);
+        if (c > 0) builder.mutate(rng, 1 + static_cast<int>(rng.below(std::max<size_t>(1, startStocks.size() / 2))));
+        builder.finish(current, c, rng, c > 0 ? 4 : 0);
+    });
+
+    std::vector<size_t> ranked(population);
+    int elites = std::max(1, population / 50);
+    auto tournament = [&](Random& rng) {
+        size_t a = rng.below(population);
+        size_t b = rng.below(population);
+        return current.fitness(a) >= current.fitness(b) ? a : b;
+    };
+    while (true) {
+        // Fewest stocks first, then the highest fitness
+        std::iota(ranked.begin(), ranked.end(), 0);
+        std::ranges::sort(ranked, [&](size_t a, size_t b) {
+            if (current.stocks(a) != current.stocks(b)) return current.stocks(a) < current.stocks(b);
+            return current.fitness(a) > current.fitness(b);
+        });
+        if (current.stocks(ranked[0]) < bestStocks) {
+            bestStocks = current.stocks(ranked[0]);
+            result.plan = toPlan(current, ranked[0]);
+            if (options.improved) options.improved(result.plan);
+        }
+        if (bestStocks <= bound || budget.exhausted()) break;
+        if (options.maxGenerations > 0 && result.generations >= options.maxGenerations) break;
+        budget.reportProgress();
+
+        ++result.generations;
+        generate([&](Builder& builder, size_t c) {
+            if (c < static_cast<size_t>(elites)) {
+                next.copy(c, current, ranked[c]);
+                return;
+            }
+            Random rng(childSeed(options.seed, result.generations, c));
+            size_t a = tournament(rng);
+            size_t b = tournament(rng);
+            builder.cross(current, a, b, rng);
+            if (rng.oneIn(3)) builder.mutate(rng, 1 + static_cast<int>(rng.below(3)));
+            builder.finish(next, c, rng, 8);
+        });
+        std::swap(current, next);
+    }
+    result.cancelled = budget.cancelled();
+    return result;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include "optimizer.h"
+#include "plan.h"
+#include "solve_control.h"
+
+class ThreadPool;
+
+struct GeneticOptions {
+    double timeLimitSeconds = 10.0;
+    long long maxGenerations = 0; // 0 leaves only the time limit
+    int population = 400; // shrunk so one arena holds at most kMaxGeneticGenes
+    unsigned long long seed = 1;
+    int threads = 1; // blocks each generation is split into; 0 = one per core, or per pool worker
+    ThreadPool* pool = nullptr; // optional; runs the blocks, else the solve starts its own
+    long long lowerBound = 0; // stop once a plan uses this few stocks
+    SolveControl* control = nullptr;
+    std::function<void(const CutPlan&)> improved; // called with each plan that saves a stock
+};
+
+struct GeneticResult {
+    CutPlan plan;
+    long long generations = 0;
+    int population = 0; // after the arena cap
+    bool cancelled = false;
+};
+
+// Pieces times chromosomes in one population arena.
+constexpr long long kMaxGeneticGenes = 1 << 24;
+
+// Falkenauer's grouping genetic algorithm. A chromosome is a sequence of
+// stocks; crossover inserts a run of stocks from one parent into the
+// other, drops the other's stocks that now repeat a piece and reinserts
+// their remaining pieces longest first with first fit. Mutation dissolves
+// a few of the emptiest stocks the same way. Fitness is the sum of squared
+// fill ratios, which selection maximizes by binary tournament; the
+// chromosomes with the fewest stocks survive as elites. Both generations
+// live in flat arenas of piece indices allocated once, and each generation
+// is built and scored in parallel blocks, on the given pool if any (see
+// ThreadPool::parallelFor) and otherwise on one owned by the solve. Every
+// child draws from its own generator seeded by (seed, generation, child),
+// so a generation limit reproduces the same plan on any number of threads.
+// `start` must be a complete plan and seeds the first generation.
+GeneticResult solveGrouping(const std::vector<Demand>& demand, Length stockLength, const CutPlan& start,
+                            const GeneticOptions& options = {});
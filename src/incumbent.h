@@ -0,0 +1,71 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "plan.h"
+
+// Best plan found so far by a running solve. Solvers offer() each complete
+// plan; one that beats the current best is copied and then published by
+// swapping a shared pointer. The lock around that pointer is held only to
+// copy or swap it, never while a plan is compared, copied or freed, so a
+// reader such as the UI can call best() every frame without stalling a
+// solver. A replaced plan is freed when the last reader that loaded it lets
+// go. The lower bound is kept apart, in an atomic, so raising it never
+// copies the plan.
+class IncumbentSlot {
+public:
+    // Publishes plan if it uses fewer stocks, or as many stocks with fewer
+    // patterns, than the current best. A better lower bound is kept either
+    // way. Returns whether plan became the new best.
+    bool offer(const CutPlan& plan) {
+        std::lock_guard lock(publishMutex); // orders publishers; readers never take it
+        long long bound = std::max(plan.lowerBound(), bestBound.load(std::memory_order_relaxed));
+        bestBound.store(bound, std::memory_order_release);
+
+        std::shared_ptr<const CutPlan> current = best();
+        bool better = !current || plan.stockCount() < current->stockCount() ||
+                      (plan.stockCount() == current->stockCount() && plan.patterns().size() < current->patterns().size());
+        if (!better) return false;
+
+        // The replaced plan is released after the swap, outside the lock
+        std::shared_ptr<const CutPlan> next = std::make_shared<const CutPlan>(plan);
+        {
+            std::lock_guard swap(latestMutex);
+            latest.swap(next);
+        }
+        return true;
+    }
+
+    // The best plan so far, or nullptr before the first one arrives. Its own
+    // lowerBound() is the one it was offered with; see lowerBound().
+    std::shared_ptr<const CutPlan> best() const {
+        std::lock_guard lock(latestMutex);
+        return latest;
+    }
+
+    // Highest lower bound any offered plan carried.
+    long long lowerBound() const { return bestBound.load(std::memory_order_acquire); }
+
+    // A copy of the best plan with the best lower bound, or an empty plan
+    // before the first one arrives.
+    CutPlan snapshot() const {
+        std::shared_ptr<const CutPlan> plan = best();
+        if (!plan) return {};
+        CutPlan copy = *plan;
+        copy.setLowerBound(std::max(copy.lowerBound(), lowerBound()));
+        return copy;
+    }
+
+    // Whether the best plan meets the best lower bound.
+    bool proved() const {
+        std::shared_ptr<const CutPlan> plan = best();
+        return plan && plan->stockCount() <= lowerBound();
+    }
+
+private:
+    std::shared_ptr<const CutPlan> latest; // guarded by latestMutex
+    mutable std::mutex latestMutex;
+    std::atomic<long long> bestBound{ 0 };
+    std::mutex publishMutex;
+};
@@ -0,0 +1,203 @@
+#include "job.h"
+#include "portfolio.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+constexpr int kDefaultStockInches = 288;
+
+struct AlgorithmName {
+    const char* name;
+    Algorithm algorithm;
+    bool listed = true; // offered in usage text; unlisted names still parse
+};
+
+constexpr AlgorithmName kAlgorithmNames[] = {
+    { "ffd", Algorithm::FirstFitDecreasing },
+    { "bfd", Algorithm::BestFitDecreasing },
+    { "column-generation", Algorithm::ColumnGeneration },
+    { "arc-flow", Algorithm::ArcFlow, false }, // only finishes on a handful of lengths
+    { "branch-and-bound", Algorithm::BranchAndBound },
+    { "anytime", Algorithm::Anytime },
+    { "portfolio", Algorithm::Portfolio },
+    { "local-search", Algorithm::LocalSearch },
+    { "genetic", Algorithm::Genetic },
+    { "min-bin-slack", Algorithm::MinBinSlack },
+    { "value-correction", Algorithm::ValueCorrection },
+};
+
+// Splits a line at spaces and tabs, keeping double-quoted fields whole and
+// dropping everything after an unquoted '#'. False on an unclosed quote.
+bool splitFields(const std::string& line, std::vector<std::string>& fields) {
+    fields.clear();
+    size_t i = 0;
+    while (i < line.size()) {
+        char c = line[i];
+        if (c == ' ' || c == '\t' || c == '\r') {
+            ++i;
+        } else if (c == '#') {
+            break;
+        } else if (c == '"') {
+            size_t close = line.find('"', i + 1);
+            if (close == std::string::npos) return false;
+            fields.push_back(line.substr(i + 1, close - i - 1));
+            i = close + 1;
+        } else {
+            size_t end = line.find_first_of(" \t\r", i);
+            if (end == std::string::npos) end = line.size();
+            fields.push_back(line.substr(i, end - i));
+            i = end;
+        }
+    }
+    return true;
+}
+
+// Job directives from any stream; path is only used in errors.
+bool readJobStream(std::istream& in, const std::string& path, Job& job, std::string& error) {
+    std::string line;
+    std::vector<std::string> fields;
+    int lineNumber = 0;
+    auto fail = [&](const std::string& reason) {
+        error = path + ":" + std::to_string(lineNumber) + ": " + reason;
+        return false;
+    };
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (!splitFields(line, fields)) return fail("unclosed quote");
+        if (fields.empty()) continue;
+        const std::string& directive = fields[0];
+
+        if (directive == "part") {
+            if (fields.size() < 4 || fields.size() > 5) return fail("expected: part DIMENSION LENGTH QUANTITY [NUMBER]");
+            double inches = 0;
+            int quantity = 0;
+            if (!parseDouble(fields[2], inches) || inches > kMaxPartInches || lengthFromInches(inches) <= 0) {
+                return fail("bad length '" + fields[2] + "'");
+            }
+            if (!parseInt(fields[3], quantity) || quantity <= 0) return fail("bad quantity '" + fields[3] + "'");
+            job.parts.push_back({ fields.size() == 5 ? fields[4] : "", lengthFromInches(inches), quantity, fields[1] });
+        } else if (directive == "stock") {
+            int inches = 0;
+            if (fields.size() != 3) return fail("expected: stock DIMENSION LENGTH");
+            if (!parseInt(fields[2], inches) || inches < 1) return fail("bad stock length '" + fields[2] + "'");
+            job.stockLengths[fields[1]] = inches;
+        } else if (directive == "algorithm") {
+            if (fields.size() != 2 || !algorithmFromName(fields[1], job.options.algorithm)) {
+                return fail("expected: algorithm NAME, one of " + algorithmNames());
+            }
+        } else if (directive == "time-limit") {
+            if (fields.size() != 2 || !parseDouble(fields[1], job.options.timeLimitSeconds) ||
+                job.options.timeLimitSeconds <= 0) {
+                return fail("expected: time-limit SECONDS");
+            }
+        } else {
+            return fail("unknown directive '" + directive + "'");
+        }
+    }
+
+    for (const auto& part : job.parts) {
+        if (!job.stockLengths.contains(part.dimension)) job.stockLengths[part.dimension] = kDefaultStockInches;
+    }
+    return true;
+}
+
+} // namespace
+
+bool parseInt(const std::string& text, int& value) {
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && end == text.data() + text.size();
+}
+
+// strtod rather than from_chars, which not every standard library has for
+// floating point yet. Rejects nan and infinity.
+bool parseDouble(const std::string& text, double& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size() && std::isfinite(value);
+}
+
+bool readJob(const std::string& path, Job& job, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = path + ": cannot open";
+        return false;
+    }
+    return readJobStream(in, path, job, error);
+}
+
+bool readJobText(const std::string& text, const std::string& name, Job& job, std::string& error) {
+    std::istringstream in(text);
+    return readJobStream(in, name, job, error);
+}
+
+std::unordered_map<std::string, CutPlan> solveJob(const Job& job, ThreadPool& pool) {
+    std::unordered_map<std::string, std::vector<Part>> partsByDimension;
+    std::unordered_map<std::string, Length> stockLengths;
+    for (const auto& part : job.parts) {
+        partsByDimension[part.dimension].push_back(part);
+        stockLengths[part.dimension] = lengthFromInches(job.stockLengths.at(part.dimension));
+    }
+    if (partsByDimension.empty()) return {};
+
+    OptimizeOptions options = job.options;
+    options.searchThreads = 0; // spread the randomized searches over the idle workers
+    Portfolio run(pool, partsByDimension, stockLengths, options);
+    run.wait();
+    return run.results();
+}
+
+bool algorithmFromName(const std::string& name, Algorithm& algorithm) {
+    for (const auto& entry : kAlgorithmNames) {
+        if (name == entry.name) {
+            algorithm = entry.algorithm;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string algorithmNames() {
+    std::string names;
+    for (const auto& entry : kAlgorithmNames) {
+        if (!entry.listed) continue;
+        if (!names.empty()) names += ", ";
+        names += entry.name;
+    }
+    return names;
+}
+
+std::string formatPlanTable(const std::unordered_map<std::string, CutPlan>& plans,
+                            const std::unordered_map<std::string, int>& stockLengths) {
+    std::vector<std::string> dims;
+    for (const auto& entry : plans) dims.push_back(entry.first);
+    std::ranges::sort(dims);
+
+    std::string table = kPlanTableHeader;
+    for (const auto& dim : dims) {
+        auto stock = stockLengths.find(dim);
+        std::string stockLength = stock != stockLengths.end() ? std::to_string(stock->second) : "";
+        const auto& patterns = plans.at(dim).patterns();
+        for (size_t i = 0; i < patterns.size(); ++i)
+            appendPlanRow(table, dim, stockLength, i, patterns[i].count, patterns[i].cuts);
+    }
+    return table;
+}
+
+void appendPlanRow(std::string& table, const std::string& dimension, const std::string& stockLength, size_t index,
+                   long long count, std::span<const Length> cuts) {
+    Length used = 0;
+    for (Length len : cuts) used += len;
+    table += dimension + "\t" + stockLength + "\t" + patternLabel(index) + "\t" + std::to_string(count) + "\t" +
+             formatLength(used, 4) + "\t";
+    for (size_t k = 0; k < cuts.size(); ++k) {
+        if (k > 0) table += ' ';
+        table += formatLength(cuts[k], 4);
+    }
+    table += '\n';
+}
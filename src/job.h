@@ -0,0 +1,63 @@
+#pragma once
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "optimizer.h"
+#include "plan.h"
+#include "thread_pool.h"
+
+// One order to optimize without the UI: the parts, the stock length of each
+// dimension in whole inches, and how to solve it.
+struct Job {
+    std::vector<Part> parts;
+    std::unordered_map<std::string, int> stockLengths; // every dimension of parts has one
+    OptimizeOptions options;
+};
+
+// Reads a job file. One directive per line, fields separated by spaces,
+// with double quotes around a field that contains spaces; '#' starts a
+// comment:
+//
+//     algorithm portfolio
+//     time-limit 5
+//     stock "2 x 2" 288
+//     part "2 x 2" 24.5 4 A-100
+//
+// A part is dimension, length in inches, quantity and an optional part
+// number. Dimensions without a stock line get the app's default of 288".
+// On failure returns false and sets error to "<path>:<line>: <reason>".
+bool readJob(const std::string& path, Job& job, std::string& error);
+
+// The same format from memory; name stands in for the path in errors.
+bool readJobText(const std::string& text, const std::string& name, Job& job, std::string& error);
+
+// Optimizes every dimension of the job at once on the pool and waits for
+// it. Empty if the job has no parts.
+std::unordered_map<std::string, CutPlan> solveJob(const Job& job, ThreadPool& pool);
+
+// A whole string as a number, for job files and command-line flags. False
+// on anything else, including trailing text, nan and infinity.
+bool parseInt(const std::string& text, int& value);
+bool parseDouble(const std::string& text, double& value);
+
+// Algorithm for a name such as "ffd", "column-generation" or "portfolio".
+bool algorithmFromName(const std::string& name, Algorithm& algorithm);
+
+// Every name algorithmFromName accepts, comma separated.
+std::string algorithmNames();
+
+// The plans as tab-separated rows, one per pattern, under a header row:
+// dimension, stock length, pattern label, repeat count, used length and the
+// cuts separated by spaces. Lengths are inches to four decimals, which is
+// exact for Length. Dimensions are sorted by name; one without a stock
+// length leaves that column empty.
+std::string formatPlanTable(const std::unordered_map<std::string, CutPlan>& plans,
+                            const std::unordered_map<std::string, int>& stockLengths);
+
+constexpr char kPlanTableHeader[] = "dimension\tstock_length\tpattern\tcount\tused\tcuts\n";
+
+// Appends the row of the index-th pattern of a dimension, for writers that
+// hold the cuts in something other than a CutPlan.
+void appendPlanRow(std::string& table, const std::string& dimension, const std::string& stockLength, size_t index,
+                   long long count, std::span<const Length> cuts);
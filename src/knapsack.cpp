@@ -0,0 +1,71 @@
+#include "knapsack.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define RODUN_KNAPSACK_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using PassFunction = void (*)(double*, uint64_t*, long long, long long, double, double);
+
+inline void scalarStep(double* value, uint64_t* taken, long long c, long long weight, double gain, double epsilon) {
+    double candidate = value[c - weight] + gain;
+    if (candidate > value[c] + epsilon) {
+        value[c] = candidate;
+        taken[c / 64] |= uint64_t(1) << (c % 64);
+    }
+}
+
+#ifdef RODUN_KNAPSACK_AVX2
+// Blocks of four capacities starting at a multiple of four, so their bits
+// land in one word. With weight >= 4 every source lies below the block and
+// has not been touched yet in this top-down pass.
+__attribute__((target("avx2")))
+void knapsackPassAvx2(double* value, uint64_t* taken, long long capacity, long long weight, double gain,
+                      double epsilon) {
+    long long c = capacity;
+    if (weight >= 4) {
+        for (; c >= weight && (c & 3) != 3; --c) scalarStep(value, taken, c, weight, gain, epsilon);
+        const __m256d gains = _mm256_set1_pd(gain);
+        const __m256d epsilons = _mm256_set1_pd(epsilon);
+        for (; c - 3 >= weight; c -= 4) {
+            long long base = c - 3;
+            __m256d current = _mm256_loadu_pd(value + base);
+            __m256d candidate = _mm256_add_pd(_mm256_loadu_pd(value + base - weight), gains);
+            __m256d better = _mm256_cmp_pd(candidate, _mm256_add_pd(current, epsilons), _CMP_GT_OQ);
+            int mask = _mm256_movemask_pd(better);
+            if (mask == 0) continue;
+            _mm256_storeu_pd(value + base, _mm256_blendv_pd(current, candidate, better));
+            taken[base / 64] |= uint64_t(mask) << (base % 64);
+        }
+    }
+    for (; c >= weight; --c) scalarStep(value, taken, c, weight, gain, epsilon);
+}
+#endif
+
+PassFunction selectPass() {
+#ifdef RODUN_KNAPSACK_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return knapsackPassAvx2;
+#endif
+    return knapsackPassScalar;
+}
+
+const PassFunction selectedPass = selectPass();
+
+} // namespace
+
+void knapsackPassScalar(double* value, uint64_t* taken, long long capacity, long long weight, double gain,
+                        double epsilon) {
+    for (long long c = capacity; c >= weight; --c) scalarStep(value, taken, c, weight, gain, epsilon);
+}
+
+void knapsackPass(double* value, uint64_t* taken, long long capacity, long long weight, double gain,
+                  double epsilon) {
+    selectedPass(value, taken, capacity, weight, gain, epsilon);
+}
+
+const char* knapsackKernelName() {
+    return selectedPass == knapsackPassScalar ? "scalar" : "avx2";
+}
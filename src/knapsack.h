@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+
+// One 0/1 pass of the knapsack DP over integer capacities 0..capacity:
+//     value[c] = max(value[c], value[c - weight] + gain)   for c >= weight,
+// updated in place from the top down. Each capacity the item improves by
+// more than epsilon gets its bit set in `taken` (one bit per capacity), so
+// the chosen items can be traced back. Bounded items are run as a sequence
+// of passes over power-of-two chunks.
+//
+// Dispatches at runtime to an AVX2 kernel, four capacities per instruction,
+// when the CPU has it, and to the scalar loop otherwise.
+void knapsackPass(double* value, uint64_t* taken, long long capacity, long long weight, double gain,
+                  double epsilon);
+
+// The portable loop knapsackPass falls back to, exposed as the reference.
+void knapsackPassScalar(double* value, uint64_t* taken, long long capacity, long long weight, double gain,
+                        double epsilon);
+
+// Name of the kernel knapsackPass dispatches to: "avx2" or "scalar".
+const char* knapsackKernelName();
@@ -0,0 +1,8 @@
+#include "length.h"
+#include <cstdio>
+
+std::string formatLength(Length length, int decimals) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, lengthToInches(length));
+    return buf;
+}
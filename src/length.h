@@ -0,0 +1,29 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+// Lengths are fixed-point integers in ten-thousandths of an inch. That is
+// exact for decimal entry to four places and for binary fractions down to
+// 1/16", so lengths compare and hash exactly. Inches as floating point only
+// appear at the UI and PDF text boundary.
+using Length = std::int64_t;
+
+constexpr Length kLengthUnitsPerInch = 10000;
+
+// Longest piece a job or cut list may ask for: far past any stock, and
+// short enough that the solvers' sums and products of lengths stay well
+// inside Length.
+constexpr double kMaxPartInches = 1e9;
+constexpr Length kMaxPartLength = static_cast<Length>(kMaxPartInches) * kLengthUnitsPerInch;
+
+inline Length lengthFromInches(double inches) {
+    return static_cast<Length>(std::llround(inches * kLengthUnitsPerInch));
+}
+
+inline double lengthToInches(Length length) {
+    return static_cast<double>(length) / kLengthUnitsPerInch;
+}
+
+// Inches with a fixed number of decimals, e.g. "12.50".
+std::string formatLength(Length length, int decimals = 2);
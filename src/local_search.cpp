@@ -0,0 +1,259 @@
+#include "local_search.h"
+#include "random.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <thread>
+#include <utility>
+
+namespace {
+
+// One chain's stocks. An empty stock is a free slot; stocks with pieces are
+// indexed by remaining length for best fit.
+class Chain {
+public:
+    Chain(const std::vector<std::vector<Length>>& start, Length stockLength, unsigned long long seed)
+        : stockLength(stockLength), rng(seed) {
+        for (const auto& cuts : start) place(open(), cuts);
+    }
+
+    long long stockCount() const { return count; }
+
+    // Sum of squared used lengths; larger means fuller stocks next to emptier ones.
+    long double concentration() const {
+        long double total = 0;
+        for (Length used : usedBy) total += static_cast<long double>(used) * static_cast<long double>(used);
+        return total;
+    }
+
+    // One ruin-and-recreate step; returns whether it was kept.
+    bool move() {
+        if (count < 2) return false;
+        touched.clear();
+        long long countBefore = count;
+        size_t sizeBefore = bins.size();
+        std::vector<int> freeBefore = freeSlots;
+
+        // Ruin: a few stocks, each the emptiest of a small random sample
+        std::vector<Length> pieces;
+        int ruin = 2 + static_cast<int>(rng.below(3));
+        for (int i = 0; i < ruin && count > 1; ++i) {
+            int victim = -1;
+            for (int sample = 0; sample < 3; ++sample) {
+                int bin = randomStock();
+                if (victim < 0 || usedBy[bin] < usedBy[victim]) victim = bin;
+            }
+            pieces.insert(pieces.end(), bins[victim].begin(), bins[victim].end());
+            clear(victim);
+        }
+
+        // Recreate: longest first with some neighbours swapped, best fit
+        // except now and then the next-best stock
+        std::sort(pieces.begin(), pieces.end(), std::greater<>());
+        for (size_t i = 0; i + 1 < pieces.size(); ++i) {
+            if (rng.oneIn(4)) std::swap(pieces[i], pieces[i + 1]);
+        }
+        for (Length len : pieces) {
+            auto it = byRemaining.lower_bound(len);
+            if (it != byRemaining.end() && rng.oneIn(5) && std::next(it) != byRemaining.end()) ++it;
+            add(it == byRemaining.end() ? open() : it->second, len);
+        }
+
+        long double gain = 0;
+        for (const auto& [bin, cuts] : touched) {
+            long double before = 0;
+            for (Length len : cuts) before += static_cast<long double>(len);
+            long double after = static_cast<long double>(usedBy[bin]);
+            gain += after * after - before * before;
+        }
+        if (count < countBefore || (count == countBefore && gain >= 0)) return true;
+
+        // Undo: put back every changed stock and drop the ones the move opened
+        for (const auto& [bin, cuts] : touched) {
+            clear(bin);
+            place(bin, cuts);
+        }
+        bins.resize(sizeBefore);
+        usedBy.resize(sizeBefore);
+        where.resize(sizeBefore);
+        freeSlots = std::move(freeBefore);
+        count = countBefore;
+        return false;
+    }
+
+    CutPlan plan() const {
+        CutPlan plan;
+        for (const auto& cuts : bins) {
+            if (cuts.empty()) continue;
+            std::vector<Length> sorted = cuts;
+            std::sort(sorted.begin(), sorted.end(), std::greater<>());
+            plan.add(std::move(sorted), 1);
+        }
+        return plan;
+    }
+
+private:
+    using RemainingIndex = std::multimap<Length, int>;
+
+    int open() {
+        if (!freeSlots.empty()) {
+            int bin = freeSlots.back();
+            freeSlots.pop_back();
+            return bin;
+        }
+        bins.emplace_back();
+        usedBy.push_back(0);
+        where.push_back(byRemaining.end());
+        return static_cast<int>(bins.size()) - 1;
+    }
+
+    void remember(int bin) {
+        for (const auto& entry : touched) {
+            if (entry.first == bin) return;
+        }
+        touched.emplace_back(bin, bins[bin]);
+    }
+
+    void add(int bin, Length len) {
+        remember(bin);
+        if (bins[bin].empty()) {
+            ++count;
+        } else {
+            byRemaining.erase(where[bin]);
+        }
+        bins[bin].push_back(len);
+        usedBy[bin] += len;
+        where[bin] = byRemaining.emplace(stockLength - usedBy[bin], bin);
+    }
+
+    // Fills a free slot without recording it; used to build and to undo.
+    void place(int bin, const std::vector<Length>& cuts) {
+        if (cuts.empty()) return;
+        bins[bin] = cuts;
+        usedBy[bin] = 0;
+        for (Length len : cuts) usedBy[bin] += len;
+        where[bin] = byRemaining.emplace(stockLength - usedBy[bin], bin);
+        ++count;
+    }
+
+    void clear(int bin) {
+        if (bins[bin].empty()) return;
+        remember(bin);
+        byRemaining.erase(where[bin]);
+        bins[bin].clear();
+        usedBy[bin] = 0;
+        freeSlots.push_back(bin);
+        --count;
+    }
+
+    int randomStock() {
+        // Free slots are few, at most one per stock saved so far
+        while (true) {
+            int bin = static_cast<int>(rng.below(bins.size()));
+            if (!bins[bin].empty()) return bin;
+        }
+    }
+
+    Length stockLength;
+    Random rng;
+    std::vector<std::vector<Length>> bins;
+    std::vector<Length> usedBy;
+    std::vector<RemainingIndex::iterator> where; // valid while the stock has pieces
+    RemainingIndex byRemaining;
+    std::vector<int> freeSlots;
+    long long count = 0;
+    std::vector<std::pair<int, std::vector<Length>>> touched; // stocks this move changed, as they were
+};
+
+struct ChainOutcome {
+    CutPlan plan;
+    long long stocks = 0;
+    long double concentration = 0;
+    long long moves = 0;
+    long long accepted = 0;
+};
+
+} // namespace
+
+LocalSearchResult ruinAndRecreate(const CutPlan& start, Length stockLength, const LocalSearchOptions& options) {
+    LocalSearchResult result;
+    SolveBudget budget(options.timeLimitSeconds, options.control);
+    if (budget.exhausted()) {
+        result.plan = start;
+        result.cancelled = budget.cancelled();
+        return result;
+    }
+
+    // Stocks holding an oversize piece have nowhere else to go, and past the
+    // emptiest kMaxSearchStocks the rest stay as they are, grouped
+    CutPlan kept;
+    std::vector<std::pair<Length, const CutPattern*>> candidates;
+    for (const auto& pattern : start.patterns()) {
+        Length used = pattern.used();
+        if (used > stockLength) {
+            kept.add(pattern.cuts, pattern.count);
+        } else {
+            candidates.emplace_back(used, &pattern);
+        }
+    }
+    std::ranges::sort(candidates, {}, [](const auto& candidate) { return candidate.first; });
+    std::vector<std::vector<Length>> stocks;
+    for (const auto& [used, pattern] : candidates) {
+        long long searched = std::min(pattern->count, kMaxSearchStocks - static_cast<long long>(stocks.size()));
+        for (long long i = 0; i < searched; ++i) stocks.push_back(pattern->cuts);
+        if (pattern->count > searched) kept.add(pattern->cuts, pattern->count - searched);
+    }
+
+    int chains = options.chains > 0 ? options.chains : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic<bool> reachedBound{ false };
+    long long boundForStocks = options.lowerBound - kept.stockCount();
+
+    auto withKept = [&](CutPlan plan) {
+        for (const auto& pattern : kept.patterns()) plan.add(pattern.cuts, pattern.count);
+        plan.setLowerBound(start.lowerBound());
+        return plan;
+    };
+
+    std::vector<ChainOutcome> outcomes(chains);
+    auto runChain = [&](int index) {
+        Chain chain(stocks, stockLength, options.seed + static_cast<unsigned long long>(index));
+        ChainOutcome& outcome = outcomes[index];
+        while (chain.stockCount() > boundForStocks && !reachedBound.load(std::memory_order_relaxed)) {
+            if (options.maxMoves > 0 && outcome.moves >= options.maxMoves) break;
+            if (outcome.moves % 64 == 0) {
+                if (budget.exhausted()) break;
+                if (index == 0) budget.reportProgress();
+            }
+            long long before = chain.stockCount();
+            ++outcome.moves;
+            if (!chain.move()) continue;
+            ++outcome.accepted;
+            if (chain.stockCount() < before && options.improved) options.improved(withKept(chain.plan()));
+        }
+        if (chain.stockCount() <= boundForStocks) reachedBound.store(true, std::memory_order_relaxed);
+        outcome.plan = chain.plan();
+        outcome.stocks = chain.stockCount();
+        outcome.concentration = chain.concentration();
+    };
+
+    if (options.pool) {
+        options.pool->parallelFor(chains, [&](size_t index) { runChain(static_cast<int>(index)); });
+    } else {
+        for (int i = 0; i < chains; ++i) runChain(i);
+    }
+
+    // Fewest stocks, then the most concentrated fill, then the lowest chain
+    size_t best = 0;
+    for (size_t i = 0; i < outcomes.size(); ++i) {
+        result.moves += outcomes[i].moves;
+        result.accepted += outcomes[i].accepted;
+        if (outcomes[i].stocks < outcomes[best].stocks ||
+            (outcomes[i].stocks == outcomes[best].stocks && outcomes[i].concentration > outcomes[best].concentration)) {
+            best = i;
+        }
+    }
+    result.plan = withKept(std::move(outcomes[best].plan));
+    result.cancelled = budget.cancelled();
+    return result;
+}
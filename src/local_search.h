@@ -0,0 +1,42 @@
+#pragma once
+#include <functional>
+#include "plan.h"
+#include "solve_control.h"
+
+class ThreadPool;
+
+// Most stocks a chain holds one by one; a plan can repeat a pattern on
+// hundreds of millions of stocks.
+constexpr long long kMaxSearchStocks = 1 << 16;
+
+struct LocalSearchOptions {
+    double timeLimitSeconds = 10.0;
+    long long maxMoves = 0; // per chain; 0 leaves only the time limit
+    unsigned long long seed = 1;
+    int chains = 1; // independent chains; 0 = one per core
+    ThreadPool* pool = nullptr; // optional; workers that are free run chains beside the calling thread
+    long long lowerBound = 0; // stop once a plan uses this few stocks
+    SolveControl* control = nullptr;
+    std::function<void(const CutPlan&)> improved; // called from the chains with each plan that saves a stock
+};
+
+struct LocalSearchResult {
+    CutPlan plan;
+    long long moves = 0; // over all chains
+    long long accepted = 0;
+    bool cancelled = false;
+};
+
+// Ruin and recreate over single stocks. Each move empties a few of the
+// worst-filled stocks and reinserts their pieces longest first with a
+// randomized best fit, keeping the result when it uses fewer stocks or as
+// many with the fill more concentrated (a larger sum of squared used
+// lengths, which drains the emptiest stocks until one disappears). Chain i
+// draws from seed + i with its own generator, so a move limit instead of a
+// time limit reproduces the same plan. `start` must be a complete plan;
+// stocks holding an oversize piece are kept as they are. Only the
+// kMaxSearchStocks emptiest stocks are searched, one entry each; the rest
+// stay grouped by pattern. With a pool, chains no worker has started run
+// on the calling thread; see ThreadPool::parallelFor.
+
+LocalSearchResult ruinAndRecreate(const CutPlan& start, Length stockLength, const LocalSearchOptions& options = {});
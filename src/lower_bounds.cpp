@@ -0,0 +1,82 @@
+#include "lower_bounds.h"
+#include "reduction.h"
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+long long ceilDiv(long long a, long long b) {
+    return a <= 0 ? 0 : (a + b - 1) / b;
+}
+
+// Martello-Toth L2 over pieces that fit the stock, longest first. For each
+// threshold K, pieces longer than C - K need a stock each, as do pieces
+// longer than C / 2; pieces of at least K that are no longer than C / 2 can
+// at best fill the room those stocks leave. Only K equal to a piece length
+// (or zero) can change the bound.
+long long martelloTothL2(const std::vector<Demand>& items, long long capacity) {
+    size_t m = items.size();
+    std::vector<long long> countPrefix(m + 1, 0), lengthPrefix(m + 1, 0);
+    for (size_t i = 0; i < m; ++i) {
+        countPrefix[i + 1] = countPrefix[i] + items[i].count;
+        lengthPrefix[i + 1] = lengthPrefix[i] + items[i].count * items[i].length;
+    }
+    // Number of leading (longest) entries whose length satisfies pred
+    auto prefixWhere = [&](auto pred) {
+        return static_cast<size_t>(std::ranges::partition_point(items, pred) - items.begin());
+    };
+    size_t large = prefixWhere([&](const Demand& d) { return 2 * d.length > capacity; });
+
+    long long best = ceilDiv(lengthPrefix[m], capacity);
+    auto evaluate = [&](long long k) {
+        size_t j1 = prefixWhere([&](const Demand& d) { return d.length > capacity - k; });
+        size_t j3 = prefixWhere([&](const Demand& d) { return d.length >= k; });
+        j1 = std::min(j1, large);
+        long long j2Count = countPrefix[large] - countPrefix[j1];
+        long long j2Room = j2Count * capacity - (lengthPrefix[large] - lengthPrefix[j1]);
+        long long j3Length = lengthPrefix[std::max(j3, large)] - lengthPrefix[large];
+        best = std::max(best, countPrefix[large] + ceilDiv(j3Length - j2Room, capacity));
+    };
+    evaluate(0);
+    for (size_t i = large; i < m; ++i) evaluate(items[i].length);
+    return best;
+}
+
+} // namespace
+
+long long LowerBounds::best() const {
+    return std::max({ continuous, martelloTothL2, martelloTothL3 });
+}
+
+LowerBounds computeLowerBounds(const std::vector<Demand>& demand, Length stockLength) {
+    LowerBounds bounds;
+    long long oversize = 0;
+    std::vector<Demand> items;
+    for (const auto& item : demand) {
+        if (item.count <= 0 || item.length <= 0) continue;
+        if (item.length > stockLength) {
+            oversize += item.count;
+        } else {
+            items.push_back(item);
+        }
+    }
+    std::ranges::sort(items, std::greater<>(), &Demand::length);
+    if (items.empty()) {
+        bounds.continuous = bounds.martelloTothL2 = bounds.martelloTothL3 = oversize;
+        return bounds;
+    }
+
+    long long total = 0;
+    for (const auto& item : items) total += item.count * item.length;
+    bounds.continuous = oversize + ceilDiv(total, stockLength);
+    bounds.martelloTothL2 = oversize + martelloTothL2(items, stockLength);
+
+    ReducedDemand reduced = reduceDemand(items, stockLength);
+    long long rest = reduced.residual.empty() ? 0 : martelloTothL2(reduced.residual, stockLength);
+    bounds.martelloTothL3 = std::max(bounds.martelloTothL2, oversize + reduced.fixed.stockCount() + rest);
+    return bounds;
+}
+
+long long quickLowerBound(const std::vector<Demand>& demand, Length stockLength) {
+    return demand.empty() ? 0 : martelloTothL2(demand, stockLength);
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <vector>
+#include "optimizer.h"
+
+// Bounds on the fewest stocks any plan for a demand can use. Pieces longer
+// than the stock each count as a stock of their own in every bound.
+struct LowerBounds {
+    long long continuous = 0; // L1: total length over stock length, rounded up
+    long long martelloTothL2 = 0;
+    long long martelloTothL3 = 0; // stocks fixed by reduceDemand plus L2 of the rest
+
+    long long best() const;
+};
+
+// L1 and L2 take O(m log m) for m distinct lengths, with piece counts only
+// entering as multiplicities; L3 adds one reduceDemand pass.
+LowerBounds computeLowerBounds(const std::vector<Demand>& demand, Length stockLength);
+
+// L2 alone, for bounding search nodes. Expects pieces no longer than the
+// stock, longest first.
+long long quickLowerBound(const std::vector<Demand>& demand, Length stockLength);
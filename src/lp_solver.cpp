@@ -0,0 +1,294 @@
+#include "lp_solver.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kPrimalTolerance = 1e-9;
+constexpr double kDualTolerance = 1e-9;
+constexpr double kPivotTolerance = 1e-9;
+constexpr size_t kRefactorInterval = 100;
+
+} // namespace
+
+LpSolver::LpSolver(int rows) : rowCount(rows) {
+    for (int i = 0; i < rows; ++i) {
+        lower.push_back(-kInfinity);
+        upper.push_back(kInfinity);
+        cost.push_back(0.0);
+        colIndex.push_back({ i });
+        colValue.push_back({ -1.0 });
+        x.push_back(0.0);
+        state.push_back(State::Basic);
+        head.push_back(i);
+    }
+}
+
+void LpSolver::setRowBounds(int row, double rowLower, double rowUpper) {
+    lower[row] = rowLower;
+    upper[row] = rowUpper;
+    if (state[row] == State::Basic) return;
+
+    // A nonbasic logical sits on a bound, so moving the bound moves the basis
+    if (state[row] == State::AtUpper && std::isfinite(rowUpper)) x[row] = rowUpper;
+    else placeAtBound(row);
+    computeBasicValues();
+}
+
+int LpSolver::addColumn(double columnCost, double colLower, double colUpper,
+                        const std::vector<int>& rowIndex, const std::vector<double>& value) {
+    lower.push_back(colLower);
+    upper.push_back(colUpper);
+    cost.push_back(columnCost);
+    colIndex.push_back(rowIndex);
+    colValue.push_back(value);
+    x.push_back(0.0);
+    state.push_back(State::Free);
+
+    int var = static_cast<int>(x.size()) - 1;
+    placeAtBound(var);
+    if (x[var] != 0.0) computeBasicValues();
+    return var - rowCount;
+}
+
+void LpSolver::placeAtBound(int var) {
+    if (std::isfinite(lower[var])) {
+        state[var] = State::AtLower;
+        x[var] = lower[var];
+    } else if (std::isfinite(upper[var])) {
+        state[var] = State::AtUpper;
+        x[var] = upper[var];
+    } else {
+        state[var] = State::Free;
+        x[var] = 0.0;
+    }
+}
+
+void LpSolver::ftran(std::vector<double>& w) const {
+    for (double& v : w) v = -v;
+    for (const Eta& eta : etas) {
+        double pivotValue = w[eta.row];
+        if (pivotValue == 0.0) continue;
+        w[eta.row] = pivotValue * eta.pivot;
+        for (size_t k = 0; k < eta.index.size(); ++k)
+            w[eta.index[k]] += eta.value[k] * pivotValue;
+    }
+}
+
+void LpSolver::btran(std::vector<double>& z) const {
+    for (auto it = etas.rbegin(); it != etas.rend(); ++it) {
+        double sum = z[it->row] * it->pivot;
+        for (size_t k = 0; k < it->index.size(); ++k)
+            sum += z[it->index[k]] * it->value[k];
+        z[it->row] = sum;
+    }
+    for (double& v : z) v = -v;
+}
+
+void LpSolver::pushEta(const std::vector<double>& alpha, int row) {
+    Eta eta{ row, 1.0 / alpha[row], {}, {} };
+    for (int i = 0; i < rowCount; ++i) {
+        if (i == row || std::abs(alpha[i]) <= 1e-14) continue;
+        eta.index.push_back(i);
+        eta.value.push_back(-alpha[i] * eta.pivot);
+    }
+    etas.push_back(std::move(eta));
+}
+
+// Rebuilds the eta file by pivoting every basic column into the slack basis.
+// A column that turns out dependent is dropped to a bound and its row's
+// logical stays basic instead.
+void LpSolver::refactor() {
+    std::vector<int> structural;
+    std::vector<bool> logicalBasic(rowCount, false);
+    for (int var : head) {
+        if (var >= rowCount) structural.push_back(var);
+        else logicalBasic[var] = true;
+    }
+    std::ranges::sort(structural, {}, [&](int var) { return colIndex[var].size(); });
+
+    etas.clear();
+    for (int i = 0; i < rowCount; ++i) head[i] = i;
+
+    std::vector<double> alpha(rowCount);
+    for (int var : structural) {
+        std::fill(alpha.begin(), alpha.end(), 0.0);
+        for (size_t k = 0; k < colIndex[var].size(); ++k) alpha[colIndex[var][k]] = colValue[var][k];
+        ftran(alpha);
+
+        int row = -1;
+        for (int i = 0; i < rowCount; ++i) {
+            if (head[i] >= rowCount || logicalBasic[head[i]]) continue;
+            if (std::abs(alpha[i]) > kPivotTolerance && (row < 0 || std::abs(alpha[i]) > std::abs(alpha[row])))
+                row = i;
+        }
+        if (row < 0) {
+            placeAtBound(var);
+            continue;
+        }
+        pushEta(alpha, row);
+        head[row] = var;
+    }
+    for (int var : head) state[var] = State::Basic;
+
+    needsRefactor = false;
+    computeBasicValues();
+}
+
+// x_B = B^-1 (-N x_N)
+void LpSolver::computeBasicValues() {
+    std::vector<double> rhs(rowCount, 0.0);
+    for (size_t var = 0; var < x.size(); ++var) {
+        if (state[var] == State::Basic || x[var] == 0.0) continue;
+        for (size_t k = 0; k < colIndex[var].size(); ++k)
+            rhs[colIndex[var][k]] -= colValue[var][k] * x[var];
+    }
+    ftran(rhs);
+    for (int i = 0; i < rowCount; ++i) x[head[i]] = rhs[i];
+}
+
+// How far a variable is outside its bounds: negative below, positive above.
+double LpSolver::infeasibility(int var) const {
+    if (x[var] < lower[var] - kPrimalTolerance) return x[var] - lower[var];
+    if (x[var] > upper[var] + kPrimalTolerance) return x[var] - upper[var];
+    return 0.0;
+}
+
+LpSolver::Status LpSolver::solve(int maxIterations) {
+    if (needsRefactor) refactor();
+
+    const int variables = static_cast<int>(x.size());
+    std::vector<double> phaseCost(rowCount);
+    std::vector<double> y(rowCount);
+    std::vector<double> alpha(rowCount);
+
+    for (int iteration = 0; iteration < maxIterations; ++iteration) {
+        if (etas.size() >= kRefactorInterval + static_cast<size_t>(rowCount)) refactor();
+
+        // Phase 1 prices the sum of infeasibilities, phase 2 the real costs
+        bool feasible = true;
+        for (int i = 0; i < rowCount; ++i) {
+            double outside = infeasibility(head[i]);
+            phaseCost[i] = outside < 0 ? -1.0 : outside > 0 ? 1.0 : 0.0;
+            if (outside != 0.0) feasible = false;
+        }
+        if (feasible) {
+            for (int i = 0; i < rowCount; ++i) phaseCost[i] = cost[head[i]];
+        }
+        y = phaseCost;
+        btran(y);
+
+        int entering = -1;
+        double bestScore = 0.0;
+        double enteringReduced = 0.0;
+        for (int var = 0; var < variables; ++var) {
+            if (state[var] == State::Basic || lower[var] == upper[var]) continue;
+            double reduced = feasible ? cost[var] : 0.0;
+            for (size_t k = 0; k < colIndex[var].size(); ++k)
+                reduced -= y[colIndex[var][k]] * colValue[var][k];
+            bool eligible = (state[var] == State::AtLower && reduced < -kDualTolerance)
+                         || (state[var] == State::AtUpper && reduced > kDualTolerance)
+                         || (state[var] == State::Free && std::abs(reduced) > kDualTolerance);
+            if (eligible && std::abs(reduced) > bestScore) {
+                bestScore = std::abs(reduced);
+                entering = var;
+                enteringReduced = reduced;
+            }
+        }
+        if (entering < 0) return feasible ? Status::Optimal : Status::Infeasible;
+
+        double direction = enteringReduced < 0 ? 1.0 : -1.0;
+        std::fill(alpha.begin(), alpha.end(), 0.0);
+        for (size_t k = 0; k < colIndex[entering].size(); ++k)
+            alpha[colIndex[entering][k]] = colValue[entering][k];
+        ftran(alpha);
+
+        // Harris two-pass ratio test: find the largest step the relaxed
+        // bounds allow, then the biggest pivot among rows that block by then.
+        // An infeasible basic variable blocks where it reaches its violated
+        // bound, since the phase 1 slope changes there, and not at all while
+        // it moves further away.
+        auto blockingBound = [&](int i, double& bound) {
+            double rate = -direction * alpha[i];
+            int var = head[i];
+            if (rate < -kPivotTolerance) {
+                if (x[var] > upper[var] + kPrimalTolerance) bound = upper[var];
+                else if (x[var] < lower[var] - kPrimalTolerance) return false;
+                else if (std::isfinite(lower[var])) bound = lower[var];
+                else return false;
+                return true;
+            }
+            if (rate > kPivotTolerance) {
+                if (x[var] < lower[var] - kPrimalTolerance) bound = lower[var];
+                else if (x[var] > upper[var] + kPrimalTolerance) return false;
+                else if (std::isfinite(upper[var])) bound = upper[var];
+                else return false;
+                return true;
+            }
+            return false;
+        };
+
+        double relaxedStep = kInfinity;
+        for (int i = 0; i < rowCount; ++i) {
+            double bound;
+            if (!blockingBound(i, bound)) continue;
+            double rate = -direction * alpha[i];
+            double slack = rate < 0 ? x[head[i]] - bound + kPrimalTolerance : bound - x[head[i]] + kPrimalTolerance;
+            relaxedStep = std::min(relaxedStep, slack / std::abs(rate));
+        }
+
+        int leaving = -1;
+        double step = kInfinity;
+        double leavingBound = 0.0;
+        for (int i = 0; i < rowCount; ++i) {
+            double bound;
+            if (!blockingBound(i, bound)) continue;
+            double ratio = std::max(0.0, (bound - x[head[i]]) / (-direction * alpha[i]));
+            if (ratio <= relaxedStep && (leaving < 0 || std::abs(alpha[i]) > std::abs(alpha[leaving]))) {
+                leaving = i;
+                step = ratio;
+                leavingBound = bound;
+            }
+        }
+
+        ++totalIterations;
+        double flipStep = upper[entering] - lower[entering];
+        if (std::isfinite(flipStep) && flipStep <= step) {
+            // The entering variable reaches its other bound first
+            for (int i = 0; i < rowCount; ++i) x[head[i]] -= direction * flipStep * alpha[i];
+            if (state[entering] == State::AtLower) {
+                state[entering] = State::AtUpper;
+                x[entering] = upper[entering];
+            } else {
+                state[entering] = State::AtLower;
+                x[entering] = lower[entering];
+            }
+            continue;
+        }
+        if (leaving < 0) return Status::Unbounded;
+
+        for (int i = 0; i < rowCount; ++i) x[head[i]] -= direction * step * alpha[i];
+        x[entering] += direction * step;
+
+        int leavingVar = head[leaving];
+        state[leavingVar] = leavingBound == lower[leavingVar] ? State::AtLower : State::AtUpper;
+        x[leavingVar] = leavingBound;
+        state[entering] = State::Basic;
+        head[leaving] = entering;
+        pushEta(alpha, leaving);
+    }
+    return Status::IterationLimit;
+}
+
+double LpSolver::objective() const {
+    double total = 0.0;
+    for (size_t var = rowCount; var < x.size(); ++var) total += cost[var] * x[var];
+    return total;
+}
+
+std::vector<double> LpSolver::duals() const {
+    std::vector<double> y(rowCount);
+    for (int i = 0; i < rowCount; ++i) y[i] = cost[head[i]];
+    btran(y);
+    return y;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <limits>
+#include <vector>
+
+// Sparse bounded-variable revised simplex for
+//     min c'x  s.t.  rowLower <= A x <= rowUpper,  colLower <= x <= colUpper.
+// The basis inverse is kept in product form, one sparse eta vector per
+// pivot, and refactored from the slack basis every so often. Columns can
+// be added and row bounds changed between solves; the next solve starts
+// from the previous basis, which is what column generation needs.
+class LpSolver {
+public:
+    enum class Status { Optimal, Infeasible, Unbounded, IterationLimit };
+
+    static constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+    explicit LpSolver(int rows);
+
+    int rows() const { return rowCount; }
+    int columns() const { return static_cast<int>(lower.size()) - rowCount; }
+
+    // Rows start out as free (-inf, inf).
+    void setRowBounds(int row, double rowLower, double rowUpper);
+
+    // Adds a column and returns its index. It starts nonbasic at its lower
+    // bound (or upper, or zero if free), so the current basis stays valid.
+    int addColumn(double cost, double colLower, double colUpper,
+                  const std::vector<int>& rowIndex, const std::vector<double>& value);
+
+    Status solve(int maxIterations = 100000);
+
+    double objective() const;
+    double value(int column) const { return x[rowCount + column]; }
+    double rowActivity(int row) const { return x[row]; }
+    std::vector<double> duals() const; // one per row, valid after Optimal
+    int iterations() const { return totalIterations; }
+
+private:
+    enum class State { Basic, AtLower, AtUpper, Free };
+
+    struct Eta {
+        int row;
+        double pivot;             // 1 / alpha[row]
+        std::vector<int> index;   // rows other than `row`
+        std::vector<double> value; // -alpha[i] / alpha[row]
+    };
+
+    // w <- B^-1 w, and z <- z B^-1 for a row vector z
+    void ftran(std::vector<double>& w) const;
+    void btran(std::vector<double>& z) const;
+    void pushEta(const std::vector<double>& alpha, int row);
+
+    void placeAtBound(int var);
+    void refactor();
+    void computeBasicValues();
+    double infeasibility(int var) const;
+
+    // Variables are the row logicals (0 .. rows-1) followed by the columns.
+    // Logical i has column -e_i, so A x - s = 0 with s bounded by the row.
+    int rowCount;
+    std::vector<double> lower, upper, cost;
+    std::vector<std::vector<int>> colIndex;
+    std::vector<std::vector<double>> colValue;
+    std::vector<double> x;
+    std::vector<State> state;
+
+    std::vector<int> head; // basis position -> variable
+    std::vector<Eta> etas; // B^-1 = E_k ... E_1 (-I)
+    bool needsRefactor = true;
+    int totalIterations = 0;
+};
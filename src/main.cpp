@@ -1,6 +1,10 @@
 #include "app.h"
+#include "cli.h"
 
-int main() {
+int main(int argc, char** argv) {
+    // Only an explicit command selects the command line; launchers pass
+    // arguments of their own to the app
+    if (isCliCommand(argc, argv)) return runCli(argc, argv);
     App::run();
     return 0;
-}
\ No newline at end of file
+}
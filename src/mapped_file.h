@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// A whole file mapped read-only into memory, unmapped on destruction. Pages
+// load on first touch, so opening costs the same for any file size.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // On failure returns false and sets error to "<path>: <reason>". An
+    // empty file maps to size 0 and a null data pointer.
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* mapping = nullptr;
+#endif
+};
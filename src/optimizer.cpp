@@ -1,28 +1,577 @@
 #include "optimizer.h"
+#include "arc_flow.h"
+#include "bin_completion.h"
+#include "column_generation.h"
+#include "genetic.h"
+#include "local_search.h"
+#include "lower_bounds.h"
+#include "reduction.h"
+#include "sequential.h"
+#include "subset_sum.h"
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
 
-// Optimize cuts for a vector of parts with given stock length.
-// Uses double precision for lengths and returns cuts in double.
-void optimizeCuts(const std::vector<Part>& parts, double stockLength, std::vector<std::vector<double>>& result) {
-    std::vector<double> allParts;
-    for (const auto& part : parts) {
-        for (int i = 0; i < part.quantity; ++i)
-            allParts.push_back(part.length);
+namespace {
+
+// Open stock groups in the order first-fit opened their stocks, kept in an
+// implicit treap. Each node carries its group's used length and the minimum
+// over its subtree, so "leftmost group whose stocks still fit len" is one
+// root-to-leaf descent, and splitting a group can insert the pieces right
+// after it in O(log n).
+class GroupIndex {
+public:
+    explicit GroupIndex(Length stockLength) : stockLength(stockLength) {}
+
+    int size() const { return sizeOf(root); }
+
+    // Position of the leftmost group that can take len, or -1 if none can.
+    int findFirstFit(Length len) const {
+        if (root < 0 || !fits(nodes[root].minUsed, len)) return -1;
+        int node = root;
+        int pos = 0;
+        while (true) {
+            const Node& n = nodes[node];
+            if (n.left >= 0 && fits(nodes[n.left].minUsed, len)) {
+                node = n.left;
+                continue;
+            }
+            pos += sizeOf(n.left);
+            if (fits(n.used, len)) return pos;
+            ++pos;
+            node = n.right;
+        }
+    }
+
+    int groupAt(int pos) const { return nodes[nodeAt(pos)].group; }
+
+    void setUsed(int pos, Length used) {
+        std::vector<int> path;
+        int node = root;
+        while (true) {
+            path.push_back(node);
+            int leftSize = sizeOf(nodes[node].left);
+            if (pos < leftSize) {
+                node = nodes[node].left;
+            } else if (pos == leftSize) {
+                break;
+            } else {
+                pos -= leftSize + 1;
+                node = nodes[node].right;
+            }
+        }
+        nodes[node].used = used;
+        for (auto it = path.rbegin(); it != path.rend(); ++it) pull(*it);
+    }
+
+    void insert(int pos, int group, Length used) {
+        nextRandom ^= nextRandom << 13;
+        nextRandom ^= nextRandom >> 7;
+        nextRandom ^= nextRandom << 17;
+        nodes.push_back({ -1, -1, nextRandom, 1, used, used, group });
+        int left, right;
+        split(root, pos, left, right);
+        root = merge(merge(left, static_cast<int>(nodes.size()) - 1), right);
+    }
+
+    // Group ids in stock order.
+    std::vector<int> groupsInOrder() const {
+        std::vector<int> order;
+        std::vector<int> stack;
+        int node = root;
+        while (node >= 0 || !stack.empty()) {
+            while (node >= 0) {
+                stack.push_back(node);
+                node = nodes[node].left;
+            }
+            node = stack.back();
+            stack.pop_back();
+            order.push_back(nodes[node].group);
+            node = nodes[node].right;
+        }
+        return order;
+    }
+
+private:
+    struct Node {
+        int left, right;
+        uint64_t priority;
+        int size;
+        Length used, minUsed;
+        int group;
+    };
+
+    bool fits(Length used, Length len) const { return used + len <= stockLength; }
+
+    int sizeOf(int node) const { return node < 0 ? 0 : nodes[node].size; }
+
+    void pull(int node) {
+        Node& n = nodes[node];
+        n.size = 1 + sizeOf(n.left) + sizeOf(n.right);
+        n.minUsed = n.used;
+        if (n.left >= 0) n.minUsed = std::min(n.minUsed, nodes[n.left].minUsed);
+        if (n.right >= 0) n.minUsed = std::min(n.minUsed, nodes[n.right].minUsed);
+    }
+
+    int nodeAt(int pos) const {
+        int node = root;
+        while (true) {
+            int leftSize = sizeOf(nodes[node].left);
+            if (pos < leftSize) {
+                node = nodes[node].left;
+            } else if (pos == leftSize) {
+                return node;
+            } else {
+                pos -= leftSize + 1;
+                node = nodes[node].right;
+            }
+        }
+    }
+
+    // Split into the first k groups and the rest.
+    void split(int node, int k, int& left, int& right) {
+        if (node < 0) {
+            left = right = -1;
+            return;
+        }
+        if (sizeOf(nodes[node].left) < k) {
+            split(nodes[node].right, k - sizeOf(nodes[node].left) - 1, nodes[node].right, right);
+            left = node;
+        } else {
+            split(nodes[node].left, k, left, nodes[node].left);
+            right = node;
+        }
+        pull(node);
+    }
+
+    int merge(int left, int right) {
+        if (left < 0) return right;
+        if (right < 0) return left;
+        if (nodes[left].priority > nodes[right].priority) {
+            nodes[left].right = merge(nodes[left].right, right);
+            pull(left);
+            return left;
+        }
+        nodes[right].left = merge(left, nodes[right].left);
+        pull(right);
+        return right;
+    }
+
+    Length stockLength;
+    int root = -1;
+    uint64_t nextRandom = 0x9E3779B97F4A7C15ull;
+    std::vector<Node> nodes;
+};
+
+// A run of identical open stocks: each holds the same cuts, longest first,
+// and there are `count` of them.
+struct StockGroup {
+    std::vector<Demand> cuts;
+    long long count;
+};
+
+struct OpenGroup {
+    StockGroup stocks;
+    Length used; // per stock
+};
+
+void addToPlan(CutPlan& plan, const StockGroup& group) {
+    std::vector<Length> cuts;
+    for (auto [len, count] : group.cuts)
+        cuts.insert(cuts.end(), count, len);
+    plan.add(std::move(cuts), group.count);
+}
+
+// Add as many copies of len to one stock as fit, up to `limit`.
+long long fillStock(Length& used, Length len, long long limit, Length stockLength) {
+    if (used + len > stockLength) return 0;
+    long long copies = std::min<long long>(limit, (stockLength - used) / len);
+    used += copies * len;
+    return copies;
+}
+
+void addCut(StockGroup& group, Length len, long long copies) {
+    if (copies > 0) group.cuts.push_back({ len, copies });
+}
+
+// Put up to `count` copies of len into the stocks of groups[id], one stock at
+// a time. If the count runs out part way through, the group is split into
+// the stocks that got a full share (kept under id), at most one stock that
+// got the remainder, and the untouched rest. Returns the ids of the new
+// pieces in stock order and decrements count by the copies placed.
+std::vector<int> placeInGroup(std::vector<OpenGroup>& groups, int id, Length len, long long& count,
+                              Length stockLength) {
+    Length used = groups[id].used;
+    long long perStock = fillStock(used, len, count, stockLength);
+    long long stocks = groups[id].stocks.count;
+
+    if (perStock * stocks <= count) {
+        addCut(groups[id].stocks, len, perStock);
+        groups[id].used = used;
+        count -= perStock * stocks;
+        return {};
+    }
+
+    OpenGroup untouched = groups[id];
+    long long full = count / perStock;
+    long long rem = count % perStock;
+    count = 0;
+
+    addCut(groups[id].stocks, len, perStock);
+    groups[id].stocks.count = full;
+    groups[id].used = used;
+
+    std::vector<int> pieces;
+    if (rem > 0) {
+        OpenGroup partial = untouched;
+        fillStock(partial.used, len, rem, stockLength);
+        addCut(partial.stocks, len, rem);
+        partial.stocks.count = 1;
+        groups.push_back(std::move(partial));
+        pieces.push_back(static_cast<int>(groups.size()) - 1);
+    }
+    untouched.stocks.count = stocks - full - (rem > 0 ? 1 : 0);
+    if (untouched.stocks.count > 0) {
+        groups.push_back(std::move(untouched));
+        pieces.push_back(static_cast<int>(groups.size()) - 1);
+    }
+    return pieces;
+}
+
+// Open as many new stocks as it takes to hold `count` copies of len, filling
+// each before starting the next. Returns the ids of the new groups.
+std::vector<int> openStocks(std::vector<OpenGroup>& groups, Length len, long long count, Length stockLength) {
+    Length used = 0;
+    long long perStock = fillStock(used, len, count, stockLength);
+    if (perStock == 0) { // longer than the stock; it still gets a stock of its own
+        perStock = 1;
+        used = len;
+    }
+
+    std::vector<int> opened;
+    long long full = count / perStock;
+    long long rem = count % perStock;
+    if (full > 0) {
+        groups.push_back({ { { { len, perStock } }, full }, used });
+        opened.push_back(static_cast<int>(groups.size()) - 1);
     }
+    if (rem > 0) {
+        Length remUsed = 0;
+        fillStock(remUsed, len, rem, stockLength);
+        groups.push_back({ { { { len, rem } }, 1 }, remUsed });
+        opened.push_back(static_cast<int>(groups.size()) - 1);
+    }
+    return opened;
+}
+
+// Reports progress by pieces placed as the heuristics walk the demand, and
+// tells them when the caller has cancelled.
+class DemandProgress {
+public:
+    DemandProgress(const std::vector<Demand>& demand, SolveControl* control) : control(control) {
+        for (const auto& item : demand) total += item.count;
+    }
+
+    // Call before placing the next `count` pieces; false means stop.
+    bool next(long long count) {
+        if (!control) return true;
+        if (control->cancelled()) return false;
+        if (total > 0) control->reportProgress(static_cast<double>(placed) / total);
+        placed += count;
+        return true;
+    }
+
+private:
+    SolveControl* control;
+    long long total = 0;
+    long long placed = 0;
+};
+
+// Place each length into the first open stock that still fits it. Produces
+// the same stocks, in the same order, as placing the pieces one by one.
+CutPlan firstFitDecreasing(const std::vector<Demand>& demand, Length stockLength, SolveControl* control) {
+    std::vector<OpenGroup> groups;
+    GroupIndex index(stockLength);
+    DemandProgress progress(demand, control);
+
+    for (auto [len, count] : demand) {
+        if (!progress.next(count)) break;
+        while (count > 0) {
+            int pos = index.findFirstFit(len);
+            if (pos < 0) {
+                for (int id : openStocks(groups, len, count, stockLength))
+                    index.insert(index.size(), id, groups[id].used);
+                break;
+            }
+            int id = index.groupAt(pos);
+            std::vector<int> pieces = placeInGroup(groups, id, len, count, stockLength);
+            index.setUsed(pos, groups[id].used);
+            for (int piece : pieces)
+                index.insert(++pos, piece, groups[piece].used);
+        }
+    }
+
+    CutPlan plan;
+    for (int id : index.groupsInOrder())
+        addToPlan(plan, groups[id].stocks);
+    return plan;
+}
 
-    std::ranges::sort(allParts, std::greater<>());
+// Place each length into the open stock with the least remaining length that
+// still fits it. Open groups sit in a multimap keyed by remaining length, so
+// the tightest fit is a lower_bound lookup.
+CutPlan bestFitDecreasing(const std::vector<Demand>& demand, Length stockLength, SolveControl* control) {
+    std::vector<OpenGroup> groups;
+    std::multimap<Length, int> byRemaining;
+    DemandProgress progress(demand, control);
 
-    for (double partLen : allParts) {
-        bool placed = false;
-        for (auto& stock : result) {
-            double used = 0.0;
-            for (double p : stock) used += p;
-            if (used + partLen <= stockLength) {
-                stock.push_back(partLen);
-                placed = true;
+    for (auto [len, count] : demand) {
+        if (!progress.next(count)) break;
+        while (count > 0) {
+            auto it = byRemaining.lower_bound(len);
+            if (it == byRemaining.end()) {
+                for (int id : openStocks(groups, len, count, stockLength))
+                    byRemaining.emplace(stockLength - groups[id].used, id);
                 break;
             }
+            int id = it->second;
+            byRemaining.erase(it);
+            std::vector<int> pieces = placeInGroup(groups, id, len, count, stockLength);
+            byRemaining.emplace(stockLength - groups[id].used, id);
+            for (int piece : pieces)
+                byRemaining.emplace(stockLength - groups[piece].used, piece);
         }
-        if (!placed) result.push_back({ partLen });
     }
+
+    CutPlan plan;
+    for (const auto& group : groups)
+        addToPlan(plan, group.stocks);
+    return plan;
+}
+
+// Sort demand longest first with an LSD radix sort on the length, one byte
+// per pass, skipping the bytes every length has in common.
+void radixSortDescending(std::vector<Demand>& demand) {
+    if (demand.empty()) return;
+    uint64_t all = ~uint64_t(0), any = 0;
+    for (const auto& item : demand) {
+        all &= static_cast<uint64_t>(item.length);
+        any |= static_cast<uint64_t>(item.length);
+    }
+
+    std::vector<Demand> buffer(demand.size());
+    for (int shift = 0; shift < 64; shift += 8) {
+        if (((all ^ any) >> shift & 0xFF) == 0) continue; // byte is the same everywhere
+
+        size_t offsets[257] = {};
+        for (const auto& item : demand)
+            ++offsets[0xFF - (static_cast<uint64_t>(item.length) >> shift & 0xFF) + 1];
+        for (int b = 0; b < 256; ++b) offsets[b + 1] += offsets[b];
+        for (const auto& item : demand)
+            buffer[offsets[0xFF - (static_cast<uint64_t>(item.length) >> shift & 0xFF)]++] = item;
+        demand.swap(buffer);
+    }
+}
+
+// Zero-waste stocks first, then first-fit decreasing for what they leave.
+CutPlan exactFitsFirst(const std::vector<Demand>& demand, Length stockLength) {
+    std::vector<Demand> rest = demand;
+    CutPlan plan = takeTightPatterns(rest, stockLength, 0);
+    std::erase_if(rest, [](const Demand& item) { return item.count <= 0; });
+    CutPlan tail = firstFitDecreasing(rest, stockLength, nullptr);
+    for (const auto& pattern : tail.patterns()) plan.add(pattern.cuts, pattern.count);
+    return plan;
+}
+
+// The fewest-stock plan of the greedy passes, which the searches improve.
+CutPlan bestGreedyPlan(const std::vector<Demand>& demand, Length stockLength) {
+    CutPlan best = firstFitDecreasing(demand, stockLength, nullptr);
+    for (CutPlan other : { bestFitDecreasing(demand, stockLength, nullptr), exactFitsFirst(demand, stockLength) }) {
+        if (other.stockCount() < best.stockCount()) best = std::move(other);
+    }
+    return best;
+}
+
+// The stocks the reduction fixed followed by a plan for the residual demand.
+CutPlan withFixedStocks(const ReducedDemand& reduced, const CutPlan& rest) {
+    CutPlan plan = reduced.fixed;
+    for (const auto& pattern : rest.patterns()) plan.add(pattern.cuts, pattern.count);
+    if (rest.lowerBound() > 0) plan.setLowerBound(reduced.fixed.stockCount() + rest.lowerBound());
+    plan.setFixedCuts(reduced.fixedCuts);
+    return plan;
+}
+
+// Runs the solvers from cheapest to strongest on the residual demand,
+// publishing each plan that beats the best so far, until a plan meets the
+// lower bound or the time budget or a cancel ends the search. The greedy
+// passes run to completion so there is always a full plan; bin completion
+// only runs on orders of at most kMaxRacedCompletionPieces pieces.
+CutPlan anytimeSearch(const ReducedDemand& reduced, Length stockLength, const OptimizeOptions& options,
+                      long long lowerBound) {
+    const std::vector<Demand>& demand = reduced.residual;
+    auto start = std::chrono::steady_clock::now();
+    auto remainingSeconds = [&] {
+        return options.timeLimitSeconds - std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    IncumbentSlot local;
+    IncumbentSlot& slot = options.incumbent ? *options.incumbent : local;
+    auto done = [&] {
+        return (options.control && options.control->cancelled()) || slot.proved();
+    };
+
+    // Best plan for the residual demand, which the exact search starts from
+    CutPlan bestRest = firstFitDecreasing(demand, stockLength, nullptr);
+    auto offer = [&](const CutPlan& rest) {
+        if (rest.stockCount() < bestRest.stockCount()) bestRest = rest;
+        slot.offer(withFixedStocks(reduced, rest));
+    };
+
+    CutPlan first = withFixedStocks(reduced, bestRest);
+    first.setLowerBound(lowerBound);
+    slot.offer(first);
+    if (!done()) offer(bestFitDecreasing(demand, stockLength, nullptr));
+    if (!done()) offer(exactFitsFirst(demand, stockLength));
+    if (!done() && remainingSeconds() > 0) {
+        auto result = solveColumnGeneration(demand, stockLength, { remainingSeconds(), 2000, options.control });
+        if (!result.cancelled) offer(result.plan);
+    }
+    long long pieces = 0;
+    for (const auto& item : demand) pieces += item.count;
+    if (!done() && remainingSeconds() > 0 && pieces <= kMaxRacedCompletionPieces) {
+        auto result = solveBinCompletion(demand, stockLength, bestRest,
+                                         { remainingSeconds(), 5000000, options.control });
+        if (!result.cancelled) offer(result.plan);
+    }
+    return slot.snapshot();
+}
+
+} // namespace
+
+std::vector<Demand> aggregateDemand(const std::vector<Part>& parts) {
+    std::vector<Demand> demand;
+    demand.reserve(parts.size());
+    for (const auto& part : parts) {
+        if (part.quantity > 0 && part.length > 0) demand.push_back({ part.length, part.quantity });
+    }
+    radixSortDescending(demand);
+
+    // Merge equal lengths, which are now adjacent
+    size_t merged = 0;
+    for (size_t i = 0; i < demand.size(); ++i) {
+        if (merged > 0 && demand[merged - 1].length == demand[i].length) {
+            demand[merged - 1].count += demand[i].count;
+        } else {
+            demand[merged++] = demand[i];
+        }
+    }
+    demand.resize(merged);
+    return demand;
+}
+
+CutPlan packDemand(const std::vector<Demand>& demand, Length stockLength, const OptimizeOptions& options) {
+    // Fix the stocks some optimal plan must contain; solvers see the rest
+    ReducedDemand reduced = reduceDemand(demand, stockLength);
+    const std::vector<Demand>& rest = reduced.residual;
+
+    // Cheap next to any solve, and tells the iterative ones when to stop
+    long long lowerBound = reduced.fixed.stockCount() + computeLowerBounds(rest, stockLength).best();
+
+    CutPlan plan;
+    switch (options.algorithm) {
+        case Algorithm::BestFitDecreasing:
+            plan = withFixedStocks(reduced, bestFitDecreasing(rest, stockLength, options.control));
+            break;
+        case Algorithm::ColumnGeneration:
+            // Skip the LP entirely when first-fit already meets the bound
+            plan = withFixedStocks(reduced, firstFitDecreasing(rest, stockLength, nullptr));
+            if (plan.stockCount() > lowerBound) {
+                CutPlan generated = withFixedStocks(reduced, solveColumnGeneration(rest, stockLength,
+                                                    { options.timeLimitSeconds, 2000, options.control }).plan);
+                if (generated.stockCount() < plan.stockCount()) plan = std::move(generated);
+            }
+            break;
+        case Algorithm::ArcFlow:
+            plan = withFixedStocks(reduced, firstFitDecreasing(rest, stockLength, nullptr));
+            if (plan.stockCount() > lowerBound) {
+                CutPlan flow = withFixedStocks(reduced, solveArcFlow(rest, stockLength,
+                                               { options.timeLimitSeconds, options.control }).plan);
+                if (flow.stockCount() < plan.stockCount()) plan = std::move(flow);
+            }
+            break;
+        case Algorithm::BranchAndBound: {
+            // The search only has to beat the better greedy plan
+            CutPlan start = firstFitDecreasing(rest, stockLength, nullptr);
+            CutPlan bestFit = bestFitDecreasing(rest, stockLength, nullptr);
+            if (bestFit.stockCount() < start.stockCount()) start = std::move(bestFit);
+            plan = withFixedStocks(reduced, solveBinCompletion(rest, stockLength, start,
+                                   { options.timeLimitSeconds, 5000000, options.control }).plan);
+            break;
+        }
+        case Algorithm::MinBinSlack:
+            plan = withFixedStocks(reduced, solveMinBinSlack(rest, stockLength,
+                                   { options.timeLimitSeconds, 100000, options.control }).plan);
+            break;
+        case Algorithm::ValueCorrection:
+            plan = withFixedStocks(reduced, firstFitDecreasing(rest, stockLength, nullptr));
+            if (plan.stockCount() > lowerBound) {
+                long long bound = lowerBound - reduced.fixed.stockCount();
+                plan = withFixedStocks(reduced, solveValueCorrection(rest, stockLength,
+                                       { options.timeLimitSeconds, options.maxIterations, 20000, bound,
+                                         options.control }).plan);
+            }
+            break;
+        case Algorithm::LocalSearch:
+        case Algorithm::Genetic: {
+            // Improve the best cheap plan unless it already meets the bound
+            CutPlan start = bestGreedyPlan(rest, stockLength);
+            auto publish = [&](const CutPlan& found) {
+                CutPlan full = withFixedStocks(reduced, found);
+                full.setLowerBound(lowerBound);
+                if (options.incumbent) options.incumbent->offer(full);
+                return full;
+            };
+            plan = publish(start);
+            if (plan.stockCount() > lowerBound && options.algorithm == Algorithm::Genetic) {
+                GeneticOptions genetic;
+                genetic.timeLimitSeconds = options.timeLimitSeconds;
+                genetic.seed = options.seed;
+                genetic.threads = options.searchThreads;
+                genetic.pool = options.pool;
+                genetic.lowerBound = lowerBound - reduced.fixed.stockCount();
+                genetic.control = options.control;
+                genetic.improved = publish;
+                plan = withFixedStocks(reduced, solveGrouping(rest, stockLength, start, genetic).plan);
+            } else if (plan.stockCount() > lowerBound) {
+                LocalSearchOptions search;
+                search.timeLimitSeconds = options.timeLimitSeconds;
+                search.seed = options.seed;
+                search.chains = options.searchThreads;
+                search.pool = options.pool;
+                search.lowerBound = lowerBound - reduced.fixed.stockCount();
+                search.control = options.control;
+                search.improved = publish;
+                plan = withFixedStocks(reduced, ruinAndRecreate(start, stockLength, search).plan);
+            }
+            break;
+        }
+        case Algorithm::Anytime:
+        case Algorithm::Portfolio:
+            plan = anytimeSearch(reduced, stockLength, options, lowerBound);
+            break;
+        case Algorithm::FirstFitDecreasing:
+        default:
+            plan = withFixedStocks(reduced, firstFitDecreasing(rest, stockLength, options.control));
+            break;
+    }
+    plan.setLowerBound(std::max(plan.lowerBound(), lowerBound));
+    if (options.control && options.control->cancelled()) return plan;
+    if (options.incumbent) options.incumbent->offer(plan);
+    if (options.control) options.control->reportProgress(1.0);
+    return plan;
+}
+
+// Optimize cuts for a vector of parts with given stock length.
+CutPlan optimizeCuts(const std::vector<Part>& parts, Length stockLength, const OptimizeOptions& options) {
+    return packDemand(aggregateDemand(parts), stockLength, options);
 }
@@ -1,13 +1,61 @@
 #pragma once
 #include <vector>
 #include <string>
+#include "length.h"
+#include "incumbent.h"
+#include "plan.h"
+#include "solve_control.h"
+
+class ThreadPool;
 
 struct Part {
     std::string part_number;
-    double length;
+    Length length;
     int quantity;
     std::string dimension;
 };
 
-void optimizeCuts(const std::vector<Part>& parts, double stockLength,
-                  std::vector<std::vector<double>>& result);
+// One distinct cut length and how many pieces of it are needed.
+struct Demand {
+    Length length;
+    long long count;
+};
+
+enum class Algorithm {
+    FirstFitDecreasing,
+    BestFitDecreasing,
+    ColumnGeneration,
+    ArcFlow, // LP over the compressed arc-flow graph, then rounding
+    BranchAndBound, // exact within its node and time limits
+    Anytime, // every solver in turn, publishing each improvement
+    Portfolio, // solvers raced on separate threads; see portfolio.h
+    LocalSearch, // best greedy plan improved by ruin and recreate
+    Genetic, // grouping genetic algorithm seeded with the best greedy plan
+    MinBinSlack, // each stock filled with the least slack a bounded search finds
+    ValueCorrection, // sequential value correction over repeated plans
+};
+
+struct OptimizeOptions {
+    Algorithm algorithm = Algorithm::FirstFitDecreasing;
+    double timeLimitSeconds = 10.0; // budget for the iterative algorithms
+    SolveControl* control = nullptr; // optional; progress and cancellation
+    IncumbentSlot* incumbent = nullptr; // optional; receives every complete plan
+    unsigned long long seed = 1; // for the randomized searches
+    int searchThreads = 1; // local search chains or genetic workers; 0 = one per core
+    ThreadPool* pool = nullptr; // optional; runs local search chains and genetic generations
+    int maxIterations = 50; // plans built by value correction
+};
+
+// Merge parts of equal length into one entry each, longest first.
+std::vector<Demand> aggregateDemand(const std::vector<Part>& parts);
+
+// Pack the demand into stocks of the given length. Time and memory depend
+// on the number of distinct lengths and cutting patterns, not on counts.
+// A cancelled solve returns early with a plan that may not cover the demand,
+// except Anytime, which always returns the best complete plan it found.
+// Portfolio needs a thread pool; called here it runs as Anytime.
+CutPlan packDemand(const std::vector<Demand>& demand, Length stockLength,
+                   const OptimizeOptions& options = {});
+
+CutPlan optimizeCuts(const std::vector<Part>& parts, Length stockLength,
+                     const OptimizeOptions& options = {});
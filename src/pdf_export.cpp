@@ -1,30 +1,53 @@
 #include "pdf_export.h"
 #include <hpdf.h>
-#include <iomanip>
 #include <sstream>
-#include <cmath>
 #include <unordered_map>
 #include <vector>
-#include <set>
+#include <algorithm>
 
 void custom_error_handler(HPDF_STATUS error_no, HPDF_STATUS detail_no, void *user_data) {
     fprintf(stderr, "Haru PDF ERROR: error_no=0x%04x, detail_no=0x%04x\n",
             (unsigned int)error_no, (unsigned int)detail_no);
 }
 
-// Updated function signature to include parts data
-void generatePDF(const std::unordered_map<std::string, std::vector<std::vector<double>>>& results,
-                const std::unordered_map<std::string, int>& stockLengths,
-                const std::vector<Part>& parts, // Add parts data
-                const std::string& outputPath) {
+// Parts that share one cut length. Cuts of a length are handed out to these
+// parts in list order, stock by stock, so parts[i] owns occurrences
+// [firstOccurrence[i], firstOccurrence[i] + quantity).
+struct LengthOwners {
+    std::vector<const Part*> parts;
+    std::vector<long long> firstOccurrence;
+    long long seen = 0; // occurrences in the patterns drawn so far
+};
+
+// Indices of the parts that own at least one of the occurrences
+// first, first + stride, ..., first + (repeats - 1) * stride, i.e. one cut
+// position of a pattern followed through all of its stocks.
+static std::vector<size_t> ownersOfCut(const LengthOwners& owners, long long first, long long stride,
+                                       long long repeats) {
+    std::vector<size_t> result;
+    long long last = first + (repeats - 1) * stride;
+    for (size_t i = 0; i < owners.parts.size(); ++i) {
+        long long from = owners.firstOccurrence[i];
+        long long to = from + owners.parts[i]->quantity; // exclusive
+        if (to <= first || from > last) continue;
+        long long r = from <= first ? 0 : (from - first + stride - 1) / stride;
+        if (r < repeats && first + r * stride < to) result.push_back(i);
+    }
+    return result;
+}
+
+// Lays out every page; the caller saves the document and frees it.
+static HPDF_Doc buildPDF(const std::unordered_map<std::string, CutPlan>& results,
+                         const std::unordered_map<std::string, int>& stockLengths,
+                         const std::vector<Part>& parts) {
 
     HPDF_Doc pdf = HPDF_New(custom_error_handler, nullptr);
-    if (!pdf) return;
+    if (!pdf) return nullptr;
 
     const HPDF_Font font = HPDF_GetFont(pdf, "Helvetica", nullptr);
     const HPDF_Font boldFont = HPDF_GetFont(pdf, "Helvetica-Bold", nullptr);
 
-    for (const auto& [dim, stocks] : results) {
+    for (const auto& [dim, plan] : results) {
         HPDF_Page page = HPDF_AddPage(pdf);
         HPDF_Page_SetSize(page, HPDF_PAGE_SIZE_A4, HPDF_PAGE_PORTRAIT);
 
@@ -47,16 +70,13 @@ void generatePDF(const std::unordered_map<std::string, std::vector<std::vector<d
         HPDF_Page_SetFontAndSize(page, boldFont, 14);
         std::string dimHeader = dim + " (" + std::to_string(stockLen) + "\")";
         HPDF_Page_TextOut(page, margin, currentY, dimHeader.c_str());
-        currentY -= 40;
-        HPDF_Page_EndText(page);
+        currentY -= 18;
 
-        // Create a mapping from length to all parts with that length for this dimension
-        std::unordered_map<double, std::vector<Part>> lengthToPartMap;
-        for (const auto& part : parts) {
-            if (part.dimension == dim) {
-                lengthToPartMap[part.length].push_back(part);
-            }
-        }
+        // Stocks used and how far that is from the lower bound
+        HPDF_Page_SetFontAndSize(page, font, 10);
+        HPDF_Page_TextOut(page, margin, currentY, describeStockCount(plan).c_str());
+        currentY -= 22;
+        HPDF_Page_EndText(page);
 
         // Create parts summary for this dimension FIRST - get all unique parts
         std::vector<Part> uniquePartsForDim;
@@ -79,38 +99,55 @@ void generatePDF(const std::unordered_map<std::string, std::vector<std::vector<d
             }
         }
 
-        // Create a counter for each part to track how many we've used
-        std::unordered_map<std::string, int> partUsageCount;
+        // Create a mapping from length to the parts that share it for this dimension
+        std::unordered_map<Length, LengthOwners> ownersByLength;
+        for (const auto& part : parts) {
+            if (part.dimension == dim) {
+                LengthOwners& owners = ownersByLength[part.length];
+                long long first = owners.firstOccurrence.empty()
+                        ? 0 : owners.firstOccurrence.back() + owners.parts.back()->quantity;
+                owners.parts.push_back(&part);
+                owners.firstOccurrence.push_back(first);
+            }
+        }
+
+        // Stock ranges each part number is cut from, for the summary table
+        std::unordered_map<std::string, std::vector<std::pair<long long, long long>>> partToStocks;
 
         // Calculate scale factor for visual representation
         float maxDrawWidth = pageWidth - 2 * margin - 100; // Leave space for labels
-        float scale = maxDrawWidth / stockLen;
+        float scale = maxDrawWidth / stockLen; // points per inch
+
+        long long firstStock = 1; // number of the first stock cut with the current pattern
+        const auto& patterns = plan.patterns();
+        for (size_t patternIndex = 0; patternIndex < patterns.size(); ++patternIndex) {
+            const CutPattern& pattern = patterns[patternIndex];
+            const std::vector<Length>& cuts = pattern.cuts;
+            long long lastStock = firstStock + pattern.count - 1;
 
-        for (size_t stockIndex = 0; stockIndex < stocks.size(); ++stockIndex) {
             if (currentY < margin + 100) { // Need new page
                 page = HPDF_AddPage(pdf);
                 HPDF_Page_SetSize(page, HPDF_PAGE_SIZE_A4, HPDF_PAGE_PORTRAIT);
                 currentY = pageHeight - margin;
             }
 
-            // Calculate total used length for this stock
-            double totalUsed = 0;
-            for (double len : stocks[stockIndex]) {
-                totalUsed += len;
-            }
-            double waste = stockLen - totalUsed;
+            // Calculate total used length for this pattern
+            Length totalUsed = pattern.used();
+            double waste = lengthToInches(lengthFromInches(stockLen) - totalUsed);
 
             // Draw stock representation
             float stockY = currentY;
-            float stockX = margin + 80; // Leave space for stock label
+            float stockX = margin + 80; // Leave space for pattern label
             float stockHeight = 40;
             float stockWidth = stockLen * scale;
 
-            // Stock label on the left
+            // Pattern label and repeat count on the left
             HPDF_Page_BeginText(page);
             HPDF_Page_SetFontAndSize(page, font, 10);
-            std::string stockLabel = "Stock " + std::to_string(stockIndex + 1);
-            HPDF_Page_TextOut(page, margin, stockY - 15, stockLabel.c_str());
+            std::string patternName = "Pattern " + patternLabel(patternIndex);
+            HPDF_Page_TextOut(page, margin, stockY - 15, patternName.c_str());
+            std::string repeatText = "x " + std::to_string(pattern.count);
+            HPDF_Page_TextOut(page, margin, stockY - 28, repeatText.c_str());
             HPDF_Page_EndText(page);
 
             // Draw main stock rectangle
@@ -123,9 +160,15 @@ void generatePDF(const std::unordered_map<std::string, std::vector<std::vector<d
             float currentPartX = stockX;
             float centerY = stockY - stockHeight / 2; // Declare centerY outside the loop
 
-            for (size_t partIndex = 0; partIndex < stocks[stockIndex].size(); ++partIndex) {
-                double partLength = stocks[stockIndex][partIndex];
-                float partWidth = partLength * scale;
+            // Cuts of each length per stock in this pattern, and how many of
+            // them the current stock has seen so far
+            std::unordered_map<Length, long long> perStock;
+            for (Length len : cuts) perStock[len]++;
+            std::unordered_map<Length, long long> rankInStock;
+
+            for (size_t partIndex = 0; partIndex < cuts.size(); ++partIndex) {
+                Length partLength = cuts[partIndex];
+                float partWidth = lengthToInches(partLength) * scale;
 
                 // Draw part rectangle with subtle fill
                 HPDF_Page_SetRGBFill(page, 0.95, 0.95, 0.95);
@@ -133,7 +176,7 @@ void generatePDF(const std::unordered_map<std::string, std::vector<std::vector<d
                 HPDF_Page_FillStroke(page);
 
                 // Draw part separator line (except for last part)
-                if (partIndex < stocks[stockIndex].size() - 1) {
+                if (partIndex < cuts.size() - 1) {
                     HPDF_Page_SetRGBStroke(page, 0.5, 0.5, 0.5);
                     HPDF_Page_SetLineWidth(page, 1);
                     HPDF_Page_MoveTo(page, currentPartX + partWidth, stockY - stockHeight);
@@ -141,57 +184,22 @@ void generatePDF(const std::unordered_map<std::string, std::vector<std::vector<d
                     HPDF_Page_Stroke(page);
                 }
 
-                // Find the correct part for this length and position
-                int partID = 1; // Default fallback
-                std::string currentPartNumber = "";
-
-                if (lengthToPartMap.find(partLength) != lengthToPartMap.end()) {
-                    const auto& partsWithLength = lengthToPartMap[partLength];
-
-                    if (partsWithLength.size() == 1) {
-                        // Only one part with this length
-                        currentPartNumber = partsWithLength[0].part_number;
-                        partID = partNumberToID[currentPartNumber];
-                    } else {
-                        // Multiple parts with same length - need to distribute them
-                        // Calculate total cuts needed for this length across all stocks
-                        int totalCutsNeeded = 0;
-                        for (const auto& p : partsWithLength) {
-                            totalCutsNeeded += p.quantity;
-                        }
-
-                        // Count how many cuts of this length we've seen so far
-                        int cutsSeenSoFar = 0;
-                        for (size_t prevStock = 0; prevStock < stockIndex; ++prevStock) {
-                            for (double prevLen : stocks[prevStock]) {
-                                if (std::abs(prevLen - partLength) < 0.01) {
-                                    cutsSeenSoFar++;
-                                }
-                            }
-                        }
-                        // Add cuts from current stock up to current part
-                        for (size_t prevPart = 0; prevPart < partIndex; ++prevPart) {
-                            if (std::abs(stocks[stockIndex][prevPart] - partLength) < 0.01) {
-                                cutsSeenSoFar++;
-                            }
-                        }
-
-                        // Determine which part this cut belongs to
-                        int cumulativeQuantity = 0;
-                        for (const auto& p : partsWithLength) {
-                            if (cutsSeenSoFar < cumulativeQuantity + p.quantity) {
-                                currentPartNumber = p.part_number;
-                                partID = partNumberToID[currentPartNumber];
-                                break;
-                            }
-                            cumulativeQuantity += p.quantity;
-                        }
+                // Find the parts this cut position goes to across every repeat
+                std::string idText = "-";
+                auto owners = ownersByLength.find(partLength);
+                if (owners != ownersByLength.end()) {
+                    long long stride = perStock[partLength];
+                    long long first = owners->second.seen + rankInStock[partLength]++;
+                    std::vector<int> ids;
+                    for (size_t i : ownersOfCut(owners->second, first, stride, pattern.count)) {
+                        int id = partNumberToID[owners->second.parts[i]->part_number];
+                        if (std::ranges::find(ids, id) == ids.end()) ids.push_back(id);
                     }
+                    if (ids.size() == 1) idText = std::to_string(ids[0]);
+                    else if (ids.size() == 2) idText = std::to_string(ids[0]) + "," + std::to_string(ids[1]);
+                    else if (ids.size() > 2) idText = std::to_string(ids[0]) + "+";
                 }
 
-                // Track usage for stock assignments
-                partUsageCount[currentPartNumber]++;
-
                 // Add part ID in circle
                 float centerX = currentPartX + partWidth / 2;
 
@@ -206,16 +214,14 @@ void generatePDF(const std::unordered_map<std::string, std::vector<std::vector<d
                 HPDF_Page_BeginText(page);
                 HPDF_Page_SetFontAndSize(page, font, 8);
                 HPDF_Page_SetRGBFill(page, 0, 0, 0);
-                std::string partNum = std::to_string(partID);
-                float numWidth = HPDF_Page_TextWidth(page, partNum.c_str());
-                HPDF_Page_TextOut(page, centerX - numWidth/2, centerY - 3, partNum.c_str());
+                float numWidth = HPDF_Page_TextWidth(page, idText.c_str());
+                HPDF_Page_TextOut(page, centerX - numWidth/2, centerY - 3, idText.c_str());
                 HPDF_Page_EndText(page);
-
                 // Add length dimension below the part
                 HPDF_Page_BeginText(page);
                 HPDF_Page_SetFontAndSize(page, font, 8);
                 std::stringstream lenStr;
-                lenStr << std::fixed << std::setprecision(2) << partLength << "\"";
+                lenStr << formatLength(partLength) << "\"";
                 std::string lengthText = lenStr.str();
                 float lengthWidth = HPDF_Page_TextWidth(page, lengthText.c_str());
                 HPDF_Page_TextOut(page, centerX - lengthWidth/2, stockY - stockHeight - 15, lengthText.c_str());
@@ -246,6 +252,11 @@ void generatePDF(const std::unordered_map<std::string, std::vector<std::vector<d
             HPDF_Page_SetFontAndSize(page, font, 9);
             HPDF_Page_SetRGBFill(page, 0, 0, 0);
             std::string totalLenText = std::to_string(stockLen) + "\" total";
+            if (pattern.count == 1) {
+                totalLenText += "  -  Stock " + std::to_string(firstStock);
+            } else {
+                totalLenText += "  -  Stocks " + std::to_string(firstStock) + "-" + std::to_string(lastStock);
+            }
             HPDF_Page_TextOut(page, stockX, stockY + 10, totalLenText.c_str());
             HPDF_Page_EndText(page);
 
@@ -262,55 +273,25 @@ void generatePDF(const std::unordered_map<std::string, std::vector<std::vector<d
             HPDF_Page_LineTo(page, stockX + stockWidth, stockY + 8);
             HPDF_Page_Stroke(page);
 
-            currentY -= 80; // Space between stocks
-        }
-
-        // Create stock mapping for summary table
-        std::unordered_map<std::string, std::vector<int>> partToStocks; // part_number -> list of stock indices
-
-        // Reset usage counter and build summary by going through each stock again
-        partUsageCount.clear();
-        for (size_t stockIndex = 0; stockIndex < stocks.size(); ++stockIndex) {
-            for (size_t partIndex = 0; partIndex < stocks[stockIndex].size(); ++partIndex) {
-                double partLength = stocks[stockIndex][partIndex];
-
-                if (lengthToPartMap.find(partLength) != lengthToPartMap.end()) {
-                    const auto& partsWithLength = lengthToPartMap[partLength];
-
-                    std::string currentPartNumber = "";
-                    if (partsWithLength.size() == 1) {
-                        currentPartNumber = partsWithLength[0].part_number;
-                    } else {
-                        // Calculate which part this cut belongs to (same logic as above)
-                        int cutsSeenSoFar = 0;
-                        for (size_t prevStock = 0; prevStock < stockIndex; ++prevStock) {
-                            for (double prevLen : stocks[prevStock]) {
-                                if (std::abs(prevLen - partLength) < 0.01) {
-                                    cutsSeenSoFar++;
-                                }
-                            }
-                        }
-                        for (size_t prevPart = 0; prevPart < partIndex; ++prevPart) {
-                            if (std::abs(stocks[stockIndex][prevPart] - partLength) < 0.01) {
-                                cutsSeenSoFar++;
-                            }
-                        }
-
-                        int cumulativeQuantity = 0;
-                        for (const auto& p : partsWithLength) {
-                            if (cutsSeenSoFar < cumulativeQuantity + p.quantity) {
-                                currentPartNumber = p.part_number;
-                                break;
-                            }
-                            cumulativeQuantity += p.quantity;
-                        }
-                    }
-
-                    if (!currentPartNumber.empty()) {
-                        partToStocks[currentPartNumber].push_back(static_cast<int>(stockIndex + 1));
-                    }
+            // Record which stocks each part is cut from
+            for (const auto& [len, stride] : perStock) {
+                auto owners = ownersByLength.find(len);
+                if (owners == ownersByLength.end()) continue;
+                LengthOwners& o = owners->second;
+                long long begin = o.seen;
+                long long end = o.seen + stride * pattern.count;
+                for (size_t i = 0; i < o.parts.size(); ++i) {
+                    long long from = std::max(begin, o.firstOccurrence[i]);
+                    long long to = std::min(end, o.firstOccurrence[i] + o.parts[i]->quantity);
+                    if (from >= to) continue;
+                    partToStocks[o.parts[i]->part_number].emplace_back(firstStock + (from - begin) / stride,
+                                                                       firstStock + (to - 1 - begin) / stride);
                 }
+                o.seen = end;
             }
+
+            firstStock = lastStock + 1;
+            currentY -= 80; // Space between stocks
         }
 
         // Add parts summary table at bottom
@@ -394,7 +375,7 @@ void generatePDF(const std::unordered_map<std::string, std::vector<std::vector<d
 
             // Length
             std::stringstream lenStr;
-            lenStr << std::fixed << std::setprecision(2) << part.length << "\"";
+            lenStr << formatLength(part.length) << "\"";
             HPDF_Page_TextOut(page, margin + 140, currentY, lenStr.str().c_str());
 
             // Quantity
@@ -403,20 +384,34 @@ void generatePDF(const std::unordered_map<std::string, std::vector<std::vector<d
             // Stock numbers - format nicely and handle overflow
             std::string stockText = "";
             if (partToStocks.find(part.part_number) != partToStocks.end()) {
-                const std::vector<int>& stockNums = partToStocks[part.part_number];
+                std::vector<std::pair<long long, long long>>& ranges = partToStocks[part.part_number];
+                std::ranges::sort(ranges);
+
+                // Merge overlapping and adjacent ranges
+                std::vector<std::pair<long long, long long>> merged;
+                for (const auto& range : ranges) {
+                    if (!merged.empty() && range.first <= merged.back().second + 1) {
+                        merged.back().second = std::max(merged.back().second, range.second);
+                    } else {
+                        merged.push_back(range);
+                    }
+                }
+
                 std::stringstream stockStr;
-                std::set<int> uniqueStocks(stockNums.begin(), stockNums.end()); // Remove duplicates and sort
+                long long stockCount = 0;
                 bool first = true;
-                for (int stockNum : uniqueStocks) {
+                for (const auto& [from, to] : merged) {
                     if (!first) stockStr << ",";
-                    stockStr << stockNum;
+                    stockStr << from;
+                    if (to > from) stockStr << "-" << to;
+                    stockCount += to - from + 1;
                     first = false;
                 }
 
                 stockText = stockStr.str();
                 if (stockText.length() > 12) {
                     // If too many stocks, show count instead
-                    stockText = std::to_string(uniqueStocks.size()) + " stocks";
+                    stockText = std::to_string(stockCount) + " stocks";
                 }
             }
             HPDF_Page_TextOut(page, margin + 210, currentY, stockText.c_str());
@@ -429,6 +424,33 @@ void generatePDF(const std::unordered_map<std::string, std::vector<std::vector<d
         HPDF_Page_EndText(page);
     }
 
-    HPDF_SaveToFile(pdf, outputPath.c_str());
+    return pdf;
+}
+
+bool generatePDF(const std::unordered_map<std::string, CutPlan>& results,
+                const std::unordered_map<std::string, int>& stockLengths,
+                const std::vector<Part>& parts,
+                const std::string& outputPath) {
+    HPDF_Doc pdf = buildPDF(results, stockLengths, parts);
+    if (!pdf) return false;
+    bool saved = HPDF_SaveToFile(pdf, outputPath.c_str()) == HPDF_OK;
+    HPDF_Free(pdf);
+    return saved;
+}
+
+std::string renderPDF(const std::unordered_map<std::string, CutPlan>& results,
+                      const std::unordered_map<std::string, int>& stockLengths,
+                      const std::vector<Part>& parts) {
+    HPDF_Doc pdf = buildPDF(results, stockLengths, parts);
+    if (!pdf) return {};
+    std::string bytes;
+    if (HPDF_SaveToStream(pdf) == HPDF_OK) {
+        HPDF_ResetStream(pdf);
+        HPDF_UINT32 size = HPDF_GetStreamSize(pdf);
+        bytes.resize(size);
+        HPDF_ReadFromStream(pdf, reinterpret_cast<HPDF_BYTE*>(bytes.data()), &size);
+        bytes.resize(size);
+    }
     HPDF_Free(pdf);
+    return bytes;
 }
\ No newline at end of file
@@ -5,10 +5,19 @@
 #include <vector>
 #include <string>
 #include "optimizer.h"
+#include "plan.h"
 
-void generatePDF(const std::unordered_map<std::string, std::vector<std::vector<double>>>& results,
+// Writes the plans to outputPath. False if libharu fails or the file
+// cannot be written.
+bool generatePDF(const std::unordered_map<std::string, CutPlan>& results,
                 const std::unordered_map<std::string, int>& stockLengths,
                 const std::vector<Part>& parts,
                 const std::string& outputPath);
 
+// The same document in memory, for sending it somewhere without a file.
+// Empty if libharu fails.
+std::string renderPDF(const std::unordered_map<std::string, CutPlan>& results,
+                      const std::unordered_map<std::string, int>& stockLengths,
+                      const std::vector<Part>& parts);
+
 #endif // PDF_EXPORT_H
\ No newline at end of file
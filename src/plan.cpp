@@ -0,0 +1,78 @@
+#include "plan.h"
+#include <cstdio>
+
+Length CutPattern::used() const {
+    Length used = 0;
+    for (Length len : cuts) used += len;
+    return used;
+}
+
+CutPlan::StockIterator::StockIterator(const std::vector<CutPattern>* patterns, size_t pattern)
+    : patterns(patterns), pattern(pattern) {
+    skipEmpty();
+}
+
+CutPlan::StockIterator& CutPlan::StockIterator::operator++() {
+    if (++repeat >= (*patterns)[pattern].count) {
+        ++pattern;
+        repeat = 0;
+        skipEmpty();
+    }
+    return *this;
+}
+
+CutPlan::StockIterator CutPlan::StockIterator::operator++(int) {
+    StockIterator previous = *this;
+    ++*this;
+    return previous;
+}
+
+void CutPlan::StockIterator::skipEmpty() {
+    while (pattern < patterns->size() && (*patterns)[pattern].count <= 0) ++pattern;
+}
+
+void CutPlan::add(std::vector<Length> cuts, long long count) {
+    if (count <= 0) return;
+    auto [it, inserted] = patternIndex.try_emplace(cuts, patternList.size());
+    if (!inserted) {
+        patternList[it->second].count += count;
+        return;
+    }
+    patternList.push_back({ std::move(cuts), count });
+}
+
+long long CutPlan::stockCount() const {
+    long long total = 0;
+    for (const auto& pattern : patternList) total += pattern.count;
+    return total;
+}
+
+Length CutPlan::usedLength() const {
+    Length total = 0;
+    for (const auto& pattern : patternList) total += pattern.used() * pattern.count;
+    return total;
+}
+
+std::string describeStockCount(const CutPlan& plan) {
+    long long stocks = plan.stockCount();
+    std::string text = std::to_string(stocks) + " stocks";
+    long long bound = plan.lowerBound();
+    if (bound <= 0) return text;
+    if (stocks <= bound) return text + " (optimal)";
+
+    char gap[96];
+    snprintf(gap, sizeof(gap), " (lower bound %lld, gap %lld = %.1f%%)", bound, stocks - bound,
+             100.0 * static_cast<double>(stocks - bound) / static_cast<double>(bound));
+    return text + gap;
+}
+
+std::string patternLabel(size_t index) {
+    std::string label;
+    ++index;
+    while (index > 0) {
+        --index;
+        label.insert(label.begin(), static_cast<char>('A' + index % 26));
+        index /= 26;
+    }
+    return label;
+}
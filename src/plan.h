@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+#include "length.h"
+
+// The cuts taken from one stock, longest first, repeated on `count` stocks.
+struct CutPattern {
+    std::vector<Length> cuts;
+    long long count;
+
+    Length used() const;
+};
+
+// Cutting plan for one stock length. Each distinct pattern is stored once
+// with its repeat count; iterating the plan expands it into one entry per
+// stock on the fly, so callers that need every stock never materialize them.
+class CutPlan {
+public:
+    class StockIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::vector<Length>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::vector<Length>*;
+        using reference = const std::vector<Length>&;
+
+        StockIterator() = default;
+        StockIterator(const std::vector<CutPattern>* patterns, size_t pattern);
+
+        reference operator*() const { return (*patterns)[pattern].cuts; }
+        pointer operator->() const { return &(*patterns)[pattern].cuts; }
+        StockIterator& operator++();
+        StockIterator operator++(int);
+        bool operator==(const StockIterator& other) const = default;
+
+        // Index of the pattern the current stock uses.
+        size_t patternIndex() const { return pattern; }
+
+    private:
+        void skipEmpty();
+
+        const std::vector<CutPattern>* patterns = nullptr;
+        size_t pattern = 0;
+        long long repeat = 0;
+    };
+
+    // Appends a pattern, merging it into an identical one if present.
+    void add(std::vector<Length> cuts, long long count);
+
+    const std::vector<CutPattern>& patterns() const { return patternList; }
+    bool empty() const { return patternList.empty(); }
+
+    long long stockCount() const;
+    Length usedLength() const;
+
+    // Fewest stocks any plan for the same demand can use, or 0 if unknown.
+    long long lowerBound() const { return bound; }
+    void setLowerBound(long long value) { bound = value; }
+
+    // Pieces placed by the reduction before any solver ran.
+    long long fixedCuts() const { return presolved; }
+    void setFixedCuts(long long value) { presolved = value; }
+
+    StockIterator begin() const { return { &patternList, 0 }; }
+    StockIterator end() const { return { &patternList, patternList.size() }; }
+
+private:
+    std::vector<CutPattern> patternList;
+    std::map<std::vector<Length>, size_t> patternIndex; // cuts -> position in patternList
+    long long bound = 0;
+    long long presolved = 0;
+};
+
+// Stock count against the lower bound, e.g. "12 stocks (optimal)" or
+// "12 stocks (lower bound 11, gap 1 = 9.1%)".
+std::string describeStockCount(const CutPlan& plan);
+
+// Spreadsheet-style pattern name: A, B, ..., Z, AA, AB, ...
+std::string patternLabel(size_t index);
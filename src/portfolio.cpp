@@ -0,0 +1,119 @@
+#include "portfolio.h"
+#include "bin_completion.h"
+#include <algorithm>
+
+std::vector<Algorithm> portfolioRacers() {
+    return { Algorithm::FirstFitDecreasing, Algorithm::BestFitDecreasing, Algorithm::ColumnGeneration,
+             Algorithm::BranchAndBound, Algorithm::LocalSearch, Algorithm::Genetic };
+}
+
+Portfolio::Portfolio(ThreadPool& pool, const std::unordered_map<std::string, std::vector<Part>>& partsByDimension,
+                     const std::unordered_map<std::string, Length>& stockLengths, const OptimizeOptions& options)
+    : started(std::chrono::steady_clock::now()) {
+    std::vector<Algorithm> algorithms = options.algorithm == Algorithm::Portfolio
+            ? portfolioRacers() : std::vector<Algorithm>{ options.algorithm };
+    // Randomized searches share out whatever workers the racers leave over
+    size_t racerCount = std::max<size_t>(1, algorithms.size() * partsByDimension.size());
+    int searchThreads = options.searchThreads > 0 ? options.searchThreads
+            : static_cast<int>(std::max<size_t>(1, pool.size() / racerCount));
+
+    for (const auto& [name, parts] : partsByDimension) {
+        auto dim = std::make_unique<Dimension>();
+        dim->name = name;
+
+        // The portfolio races bin completion only on orders small enough for it
+        long long pieces = 0;
+        for (const auto& part : parts) pieces += part.quantity;
+        std::vector<Algorithm> racers = algorithms;
+        if (options.algorithm == Algorithm::Portfolio && pieces > kMaxRacedCompletionPieces)
+            std::erase(racers, Algorithm::BranchAndBound);
+
+        // Every control exists before any racer starts, so a racer can cancel all of them
+        for (size_t i = 0; i < racers.size(); ++i) dim->racers.push_back(std::make_unique<SolveControl>());
+
+        auto demand = std::make_shared<const std::vector<Demand>>(aggregateDemand(parts));
+        Length stockLength = stockLengths.at(name);
+
+        // First-fit is published before any racer is queued, so a dimension
+        // whose racers start too late to run still has a plan
+        OptimizeOptions seed = options;
+        seed.algorithm = Algorithm::FirstFitDecreasing;
+        seed.control = nullptr;
+        seed.incumbent = &dim->incumbent;
+        packDemand(*demand, stockLength, seed);
+        if (dim->incumbent.proved()) {
+            for (auto& racer : dim->racers) racer->cancel();
+        }
+
+        for (size_t i = 0; i < racers.size(); ++i) {
+            Dimension* shared = dim.get();
+            OptimizeOptions racer = options;
+            racer.algorithm = racers[i];
+            racer.control = dim->racers[i].get();
+            racer.incumbent = &dim->incumbent;
+            racer.searchThreads = searchThreads;
+            racer.pool = &pool;
+            auto start = started;
+            tasks.push_back(pool.submit([shared, demand, stockLength, racer, start]() mutable {
+                // The budget runs from the start of the race, not of this task
+                racer.timeLimitSeconds -= std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (!racer.control->cancelled() && racer.timeLimitSeconds > 0) {
+                    packDemand(*demand, stockLength, racer);
+
+                    // First to the lower bound stops the others
+                    if (shared->incumbent.proved()) {
+                        for (auto& racer : shared->racers) racer->cancel();
+                    }
+                }
+                racer.control->reportProgress(1.0);
+            }));
+        }
+        dims.push_back(std::move(dim));
+    }
+}
+
+Portfolio::~Portfolio() {
+    cancel();
+    for (auto& task : tasks) task.wait();
+}
+
+double Portfolio::progress() const {
+    double total = 0.0;
+    size_t racers = 0;
+    for (const auto& dim : dims) {
+        for (const auto& racer : dim->racers) total += racer->progress();
+        racers += dim->racers.size();
+    }
+    return racers == 0 ? 1.0 : total / static_cast<double>(racers);
+}
+
+double Portfolio::elapsedSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+}
+
+bool Portfolio::finished() const {
+    for (const auto& task : tasks) {
+        if (task.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+    }
+    return true;
+}
+
+void Portfolio::wait() {
+    for (auto& task : tasks) task.wait();
+}
+
+void Portfolio::cancel() {
+    stopped = true;
+    for (auto& dim : dims) {
+        for (auto& racer : dim->racers) racer->cancel();
+    }
+}
+
+std::unordered_map<std::string, CutPlan> Portfolio::results() const {
+    std::unordered_map<std::string, CutPlan> plans;
+    for (const auto& dim : dims) {
+        if (!dim->incumbent.best()) return {};
+        plans[dim->name] = dim->incumbent.snapshot();
+    }
+    return plans;
+}
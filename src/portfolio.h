@@ -0,0 +1,58 @@
+#pragma once
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "incumbent.h"
+#include "optimizer.h"
+#include "solve_control.h"
+#include "thread_pool.h"
+
+// Optimizes every dimension of an order at once on a thread pool. Each
+// dimension runs its racers as separate pool tasks: the Portfolio algorithm
+// races every solver in portfolioRacers(), any other algorithm runs alone.
+// A dimension's racers share its incumbent, the first plan to meet the
+// lower bound cancels the rest, and they all share one wall-clock budget.
+// The incumbent starts with a first-fit plan made before any racer is
+// queued, so every dimension has a plan even if its racers never get a
+// worker in time. A racer waits only on work a worker has already started
+// (see ThreadPool::parallelFor), never on queued tasks.
+class Portfolio {
+public:
+    struct Dimension {
+        std::string name;
+        IncumbentSlot incumbent; // best complete plan so far, read without locking
+        std::vector<std::unique_ptr<SolveControl>> racers;
+    };
+
+    Portfolio(ThreadPool& pool, const std::unordered_map<std::string, std::vector<Part>>& partsByDimension,
+              const std::unordered_map<std::string, Length>& stockLengths, const OptimizeOptions& options);
+    ~Portfolio(); // cancels the racers and waits for them
+
+    Portfolio(const Portfolio&) = delete;
+    Portfolio& operator=(const Portfolio&) = delete;
+
+    const std::vector<std::unique_ptr<Dimension>>& dimensions() const { return dims; }
+
+    double progress() const;
+    double elapsedSeconds() const;
+    bool finished() const;
+    void wait(); // until every racer has returned
+
+    void cancel();
+    bool cancelled() const { return stopped; }
+
+    // The best plan of every dimension, or nothing unless all have one.
+    std::unordered_map<std::string, CutPlan> results() const;
+
+private:
+    std::vector<std::unique_ptr<Dimension>> dims;
+    std::vector<std::future<void>> tasks;
+    std::chrono::steady_clock::time_point started;
+    bool stopped = false;
+};
+
+// The solvers the Portfolio algorithm races on each dimension.
+std::vector<Algorithm> portfolioRacers();
@@ -0,0 +1,259 @@
+#include "project.h"
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+// The records are written and read as the compiler lays them out, so pin
+// that layout down
+static_assert(std::endian::native == std::endian::little, "project files are little-endian");
+static_assert(sizeof(ProjectHeader) == 136 && std::is_trivially_copyable_v<ProjectHeader>);
+static_assert(sizeof(ProjectDimension) == 48 && std::is_trivially_copyable_v<ProjectDimension>);
+static_assert(sizeof(ProjectPart) == 24 && std::is_trivially_copyable_v<ProjectPart>);
+static_assert(sizeof(ProjectPattern) == 24 && std::is_trivially_copyable_v<ProjectPattern>);
+static_assert(std::is_same_v<Length, int64_t>);
+
+namespace {
+
+// Each distinct string once, numbered in order of first use.
+class StringTable {
+public:
+    uint32_t intern(const std::string& text) {
+        auto [it, added] = index.try_emplace(text, static_cast<uint32_t>(offsets.size() - 1));
+        if (added) {
+            bytes += text;
+            offsets.push_back(bytes.size());
+        }
+        return it->second;
+    }
+
+    std::vector<uint64_t> offsets{ 0 };
+    std::string bytes;
+
+private:
+    std::unordered_map<std::string, uint32_t> index;
+};
+
+// Appends an array to the image on an 8-byte boundary.
+template <typename T>
+ProjectSection appendSection(std::string& image, const T* data, size_t count, size_t size = sizeof(T)) {
+    image.resize((image.size() + 7) / 8 * 8, '\0');
+    ProjectSection section{ image.size(), count };
+    image.append(reinterpret_cast<const char*>(data), count * size);
+    return section;
+}
+
+// The records of a section, if it lies inside the file and is aligned.
+template <typename T>
+bool mapSection(const MappedFile& file, const ProjectSection& section, std::span<const T>& records) {
+    if (section.offset % alignof(T) != 0 || section.offset > file.size() ||
+        section.count > (file.size() - section.offset) / sizeof(T)) {
+        return false;
+    }
+    records = { reinterpret_cast<const T*>(file.data() + section.offset), static_cast<size_t>(section.count) };
+    return true;
+}
+
+bool inRange(uint64_t first, uint64_t count, size_t size) {
+    return count <= size && first <= size - count;
+}
+
+// A job keeps stock lengths in whole inches, as an int; 0 means none was set.
+bool validStockLength(Length length) {
+    if (length == 0) return true;
+    if (length < 0) return false;
+    long long inches = std::llround(lengthToInches(length));
+    return inches >= 1 && inches <= INT_MAX;
+}
+
+int stockInches(Length length) {
+    return static_cast<int>(std::llround(lengthToInches(length)));
+}
+
+} // namespace
+
+bool ProjectView::open(const std::string& path, std::string& error) {
+    head = nullptr;
+    if (!file.open(path, error)) return false;
+    auto fail = [&](const std::string& reason) {
+        error = path + ": " + reason;
+        head = nullptr;
+        file.close();
+        return false;
+    };
+    if (file.size() < sizeof(ProjectHeader) || std::memcmp(file.data(), kProjectMagic, sizeof(kProjectMagic)) != 0) {
+        return fail("not a Rodun project");
+    }
+    head = reinterpret_cast<const ProjectHeader*>(file.data());
+    if (head->version == 0 || head->version > kProjectVersion) {
+        return fail("written by a newer Rodun (format version " + std::to_string(head->version) + ")");
+    }
+    if (head->fileSize != file.size()) return fail("truncated");
+
+    // Bounds only: a damaged file must not send a reader outside the mapping
+    std::span<const char> byteSpan;
+    if (!mapSection(file, head->stringOffsets, offsets) || !mapSection(file, head->stringBytes, byteSpan) ||
+        !mapSection(file, head->dimensions, dims) || !mapSection(file, head->parts, partList) ||
+        !mapSection(file, head->patterns, patternList) || !mapSection(file, head->cuts, cutList) ||
+        offsets.empty()) {
+        return fail("damaged section table");
+    }
+    bytes = byteSpan.data();
+    if (offsets.front() != 0 || offsets.back() != byteSpan.size() || !std::ranges::is_sorted(offsets)) {
+        return fail("damaged string table");
+    }
+    size_t strings = offsets.size() - 1;
+    if (head->algorithm > static_cast<uint32_t>(Algorithm::ValueCorrection)) return fail("unknown algorithm");
+    if (!std::isfinite(head->timeLimitSeconds) || head->timeLimitSeconds <= 0) return fail("bad time limit");
+    for (const auto& dim : dims) {
+        if (dim.name >= strings || !inRange(dim.firstPattern, dim.patternCount, patternList.size())) {
+            return fail("damaged dimension");
+        }
+        if (!validStockLength(dim.stockLength)) return fail("bad stock length");
+        if (dim.planned && dim.stockLength == 0) return fail("plan without a stock length");
+    }
+    for (const auto& part : partList) {
+        if (part.partNumber >= strings || part.dimension >= dims.size() || part.length <= 0 || part.quantity <= 0 ||
+            part.quantity > INT_MAX) {
+            return fail("damaged part");
+        }
+        // Solving needs the stock length of every dimension with parts
+        if (dims[part.dimension].stockLength == 0) return fail("part without a stock length");
+    }
+    for (const auto& pattern : patternList) {
+        if (!inRange(pattern.firstCut, pattern.cutCount, cutList.size()) || pattern.count < 0) {
+            return fail("damaged pattern");
+        }
+    }
+    return true;
+}
+
+bool ProjectView::planned() const {
+    return std::ranges::all_of(partList, [&](const ProjectPart& part) { return dims[part.dimension].planned != 0; });
+}
+
+bool saveProject(const std::string& path, const Job& job, const std::unordered_map<std::string, CutPlan>& plans,
+                 std::string& error) {
+    std::vector<std::string> names;
+    for (const auto& entry : job.stockLengths) names.push_back(entry.first);
+    for (const auto& entry : plans) names.push_back(entry.first);
+    for (const auto& part : job.parts) names.push_back(part.dimension);
+    std::ranges::sort(names);
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+
+    StringTable strings;
+    std::vector<ProjectDimension> dims;
+    std::vector<ProjectPattern> patterns;
+    std::vector<Length> cuts;
+    std::unordered_map<std::string, uint32_t> dimIndex;
+    for (const auto& name : names) {
+        dimIndex[name] = static_cast<uint32_t>(dims.size());
+        ProjectDimension& dim = dims.emplace_back();
+        dim.name = strings.intern(name);
+        auto stock = job.stockLengths.find(name);
+        dim.stockLength = stock != job.stockLengths.end() ? lengthFromInches(stock->second) : 0;
+        dim.firstPattern = patterns.size();
+        auto plan = plans.find(name);
+        if (plan == plans.end()) continue;
+        dim.planned = 1;
+        dim.lowerBound = plan->second.lowerBound();
+        dim.fixedCuts = plan->second.fixedCuts();
+        dim.patternCount = plan->second.patterns().size();
+        for (const auto& pattern : plan->second.patterns()) {
+            patterns.push_back({ cuts.size(), pattern.cuts.size(), pattern.count });
+            cuts.insert(cuts.end(), pattern.cuts.begin(), pattern.cuts.end());
+        }
+    }
+    std::vector<ProjectPart> parts;
+    parts.reserve(job.parts.size());
+    for (const auto& part : job.parts) {
+        parts.push_back({ strings.intern(part.part_number), dimIndex.at(part.dimension), part.length, part.quantity });
+    }
+
+    ProjectHeader header{};
+    std::memcpy(header.magic, kProjectMagic, sizeof(header.magic));
+    header.version = kProjectVersion;
+    header.algorithm = static_cast<uint32_t>(job.options.algorithm);
+    header.timeLimitSeconds = job.options.timeLimitSeconds;
+    header.seed = job.options.seed;
+    std::string image(sizeof(header), '\0');
+    header.stringOffsets = appendSection(image, strings.offsets.data(), strings.offsets.size());
+    header.stringBytes = appendSection(image, strings.bytes.data(), strings.bytes.size());
+    header.dimensions = appendSection(image, dims.data(), dims.size());
+    header.parts = appendSection(image, parts.data(), parts.size());
+    header.patterns = appendSection(image, patterns.data(), patterns.size());
+    header.cuts = appendSection(image, cuts.data(), cuts.size());
+    header.fileSize = image.size();
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(image.data(), static_cast<std::streamsize>(image.size()));
+        out.close();
+        if (!out) {
+            std::filesystem::remove(temporary);
+            error = path + ": cannot write";
+            return false;
+        }
+    }
+    std::error_code renamed;
+    std::filesystem::rename(temporary, path, renamed);
+    if (renamed) {
+        std::filesystem::remove(temporary);
+        error = path + ": " + renamed.message();
+        return false;
+    }
+    return true;
+}
+
+bool loadProject(const std::string& path, Job& job, std::unordered_map<std::string, CutPlan>& plans,
+                 std::string& error) {
+    ProjectView view;
+    if (!view.open(path, error)) return false;
+
+    job = {};
+    plans.clear();
+    const ProjectHeader& header = view.header();
+    job.options.algorithm = static_cast<Algorithm>(header.algorithm);
+    job.options.timeLimitSeconds = header.timeLimitSeconds;
+    job.options.seed = header.seed;
+    for (const auto& dim : view.dimensions()) {
+        std::string name(view.string(dim.name));
+        if (dim.stockLength > 0) job.stockLengths[name] = stockInches(dim.stockLength);
+        if (!dim.planned) continue;
+        CutPlan& plan = plans[name];
+        for (const auto& pattern : view.patterns(dim)) {
+            auto cuts = view.cuts(pattern);
+            plan.add({ cuts.begin(), cuts.end() }, pattern.count);
+        }
+        plan.setLowerBound(dim.lowerBound);
+        plan.setFixedCuts(dim.fixedCuts);
+    }
+    job.parts.reserve(view.parts().size());
+    for (const auto& part : view.parts()) {
+        job.parts.push_back({ std::string(view.string(part.partNumber)), part.length, static_cast<int>(part.quantity),
+                              std::string(view.string(view.dimensions()[part.dimension].name)) });
+    }
+    return true;
+}
+
+std::string formatPlanTable(const ProjectView& project) {
+    // saveProject stores the dimensions sorted by name, as the table lists them
+    std::string table = kPlanTableHeader;
+    for (const auto& dim : project.dimensions()) {
+        if (!dim.planned) continue;
+        std::string name(project.string(dim.name));
+        std::string stockLength = std::to_string(stockInches(dim.stockLength));
+        size_t index = 0;
+        for (const auto& pattern : project.patterns(dim)) {
+            if (pattern.count > 0) appendPlanRow(table, name, stockLength, index++, pattern.count, project.cuts(pattern));
+        }
+    }
+    return table;
+}
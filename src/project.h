@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "job.h"
+#include "mapped_file.h"
+
+// Project files (.rodun) hold a job and its plans as one flat image that is
+// memory-mapped and read in place, so opening one costs the same whether
+// the plan has ten cuts or a million. Everything is little-endian and
+// 8-byte aligned; records refer to each other by index, and the header
+// locates each section by byte offset from the start of the file:
+//
+//     ProjectHeader
+//     string offsets  uint64_t[strings + 1] into the string bytes
+//     string bytes    every dimension name and part number, each stored once
+//     dimensions      ProjectDimension[], sorted by name
+//     parts           ProjectPart[]
+//     patterns        ProjectPattern[], each dimension's in one run
+//     cuts            Length[], each pattern's in one run
+//
+// Readers reject a newer version. A new version may append fields to the
+// header and add sections, but keeps existing records as they are.
+constexpr char kProjectMagic[8] = { 'R', 'O', 'D', 'U', 'N', 'P', 'R', 'J' };
+constexpr uint32_t kProjectVersion = 1;
+
+struct ProjectSection {
+    uint64_t offset;
+    uint64_t count; // records, or bytes for the string bytes
+};
+
+struct ProjectHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t algorithm; // Algorithm the job asks for
+    double timeLimitSeconds;
+    uint64_t seed;
+    uint64_t fileSize; // catches a truncated copy
+    ProjectSection stringOffsets;
+    ProjectSection stringBytes;
+    ProjectSection dimensions;
+    ProjectSection parts;
+    ProjectSection patterns;
+    ProjectSection cuts;
+};
+
+struct ProjectDimension {
+    uint32_t name; // string index
+    uint32_t planned; // 1 if the patterns below are a plan, 0 if never optimized
+    Length stockLength;
+    int64_t lowerBound;
+    int64_t fixedCuts;
+    uint64_t firstPattern;
+    uint64_t patternCount;
+};
+
+struct ProjectPart {
+    uint32_t partNumber; // string index
+    uint32_t dimension; // index into the dimensions
+    Length length;
+    int64_t quantity;
+};
+
+struct ProjectPattern {
+    uint64_t firstCut;
+    uint64_t cutCount;
+    int64_t count; // stocks cut this way
+};
+
+// A project file mapped read-only. open checks the header, that every
+// index and range stays inside the file, and that the job can be solved
+// as it stands: a positive time limit, stock lengths that fit a job, and
+// one for every dimension with parts or a plan. After that the accessors
+// return views into the mapping without copying.
+class ProjectView {
+public:
+    bool open(const std::string& path, std::string& error);
+
+    // Whether every dimension with parts has a plan.
+    bool planned() const;
+
+    const ProjectHeader& header() const { return *head; }
+    std::span<const ProjectDimension> dimensions() const { return dims; }
+    std::span<const ProjectPart> parts() const { return partList; }
+    std::span<const ProjectPattern> patterns(const ProjectDimension& dimension) const {
+        return patternList.subspan(dimension.firstPattern, dimension.patternCount);
+    }
+    std::span<const Length> cuts(const ProjectPattern& pattern) const {
+        return cutList.subspan(pattern.firstCut, pattern.cutCount);
+    }
+    std::string_view string(uint32_t index) const {
+        return { bytes + offsets[index], static_cast<size_t>(offsets[index + 1] - offsets[index]) };
+    }
+
+private:
+    MappedFile file;
+    const ProjectHeader* head = nullptr;
+    std::span<const uint64_t> offsets;
+    const char* bytes = nullptr;
+    std::span<const ProjectDimension> dims;
+    std::span<const ProjectPart> partList;
+    std::span<const ProjectPattern> patternList;
+    std::span<const Length> cutList;
+};
+
+// Writes the job and whichever dimensions have a plan. The file is written
+// beside path and renamed over it, so a failed save leaves the old one.
+bool saveProject(const std::string& path, const Job& job, const std::unordered_map<std::string, CutPlan>& plans,
+                 std::string& error);
+
+// The plans as formatPlanTable writes them, straight from the mapping;
+// batch mode prints a fully planned project this way without loading it.
+std::string formatPlanTable(const ProjectView& project);
+
+// Reads a project back into the types the app and batch mode work with.
+// Stock lengths round to whole inches, as Job keeps them.
+bool loadProject(const std::string& path, Job& job, std::unordered_map<std::string, CutPlan>& plans,
+                 std::string& error);
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+
+// xorshift64; unlike the standard distributions it draws the same sequence
+// on every standard library, which keeps seeded runs reproducible.
+class Random {
+public:
+    explicit Random(unsigned long long seed) : state(seed * 0x9E3779B97F4A7C15ull | 1) {}
+
+    unsigned long long next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    size_t below(size_t n) { return static_cast<size_t>(next() % n); }
+    bool oneIn(unsigned n) { return next() % n == 0; }
+
+private:
+    unsigned long long state;
+};
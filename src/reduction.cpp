@@ -0,0 +1,110 @@
+#include "reduction.h"
+#include "subset_sum.h"
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <numeric>
+
+namespace {
+
+// Bitset words times piece groups all fill tests of one reduction may touch;
+// past that only the cheap two-smallest test is used
+constexpr long long kFillWorkBudget = 1 << 22;
+
+// Longest total of free pieces that fits in room, on the length grid; -1
+// if the test would overrun the budget.
+long long bestFill(const std::map<Length, long long>& free, long long room, long long grid, long long& budget) {
+    if (budget <= 0) return -1;
+    std::vector<long long> weights, copies;
+    for (const auto& [length, count] : free) {
+        if (length > room) break;
+        weights.push_back(length / grid);
+        copies.push_back(count);
+    }
+    long long capacity = room / grid;
+    long long work = SubsetSum::work(weights, copies, capacity);
+    if (work > budget) {
+        budget = 0; // later rooms are no smaller, so stop trying
+        return -1;
+    }
+    budget -= work;
+    return SubsetSum(weights, copies, capacity).best(capacity) * grid;
+}
+
+} // namespace
+
+ReducedDemand reduceDemand(const std::vector<Demand>& demand, Length stockLength) {
+    ReducedDemand result;
+    std::map<Length, long long> free; // shortest first
+    std::vector<Demand> oversize;
+    long long grid = stockLength;
+    for (const auto& item : demand) {
+        if (item.count <= 0 || item.length <= 0) continue;
+        if (item.length > stockLength) {
+            oversize.push_back(item);
+            continue;
+        }
+        free[item.length] += item.count;
+        grid = std::gcd(grid, item.length);
+    }
+
+    auto take = [&](Length length, long long count) {
+        auto it = free.find(length);
+        if ((it->second -= count) == 0) free.erase(it);
+    };
+
+    long long fillBudget = kFillWorkBudget;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        std::vector<Length> order;
+        for (const auto& entry : free) order.push_back(entry.first);
+
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            Length length = *it;
+            while (free.contains(length)) {
+                long long copies = free[length];
+                take(length, 1); // consider one copy against everything else
+
+                auto fit = free.upper_bound(stockLength - length);
+                if (fit == free.begin()) {
+                    // Nothing fits beside it, so nothing fits beside the other copies
+                    if (copies > 1) take(length, copies - 1);
+                    result.fixed.add({ length }, copies);
+                    result.fixedCuts += copies;
+                    changed = true;
+                    break;
+                }
+                Length companion = std::prev(fit)->first;
+
+                // With no room for two more pieces the longest that fits is
+                // the best fill; otherwise check every combination
+                long long others = 0;
+                Length smallest = 0, second = 0;
+                for (auto s = free.begin(); s != free.end() && others < 2; ++s) {
+                    if (others == 0) smallest = s->first;
+                    second = s->first;
+                    others += s->second;
+                }
+                bool dominant = others < 2 || length + smallest + second > stockLength ||
+                                bestFill(free, stockLength - length, grid, fillBudget) == companion;
+                free[length] += 1;
+                if (!dominant) break;
+
+                // Later copies see fewer pieces, so the pair stays dominant
+                // while the companion lasts
+                long long pairs = companion == length ? copies / 2 : std::min(copies, free[companion]);
+                take(length, pairs);
+                take(companion, pairs);
+                result.fixed.add({ std::max(length, companion), std::min(length, companion) }, pairs);
+                result.fixedCuts += 2 * pairs;
+                changed = true;
+            }
+        }
+    }
+
+    result.residual = std::move(oversize);
+    for (auto it = free.rbegin(); it != free.rend(); ++it) result.residual.push_back({ it->first, it->second });
+    std::ranges::sort(result.residual, std::greater<>(), &Demand::length);
+    return result;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <vector>
+#include "optimizer.h"
+#include "plan.h"
+
+// Demand split into stocks some optimal plan is known to contain and the
+// pieces left for a solver to place.
+struct ReducedDemand {
+    CutPlan fixed;
+    std::vector<Demand> residual; // longest first
+    long long fixedCuts = 0;      // pieces placed in `fixed`
+};
+
+// Martello-Toth style dominance reduction, longest piece first. A piece
+// nothing else fits beside is cut alone; a piece whose leftover room no
+// combination of other pieces fills better than the single longest piece
+// that fits is cut with that piece. Passes repeat until nothing changes.
+// Pieces longer than the stock stay in the residual.
+ReducedDemand reduceDemand(const std::vector<Demand>& demand, Length stockLength);
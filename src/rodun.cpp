@@ -0,0 +1,194 @@
+#include "rodun.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "pdf_export.h"
+#include "portfolio.h"
+#include "thread_pool.h"
+
+static_assert(RODUN_UNITS_PER_INCH == kLengthUnitsPerInch);
+static_assert(std::is_same_v<rodun_length, Length>);
+static_assert(RODUN_VALUE_CORRECTION == static_cast<int>(Algorithm::ValueCorrection));
+
+struct rodun_job {
+    std::vector<Part> parts;
+    std::unordered_map<std::string, Length> stockLengths;
+
+    // Filled by a solve, one entry per dimension, sorted by name
+    std::vector<std::string> dimensions;
+    std::vector<CutPlan> plans;
+};
+
+namespace {
+
+constexpr Length kDefaultStockLength = 288 * kLengthUnitsPerInch;
+
+// Started on the first solve and shared by every job after it.
+ThreadPool& sharedPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// Status for the exception being handled; none may cross into C.
+rodun_status currentErrorStatus() {
+    try {
+        throw;
+    } catch (const std::bad_alloc&) {
+        return RODUN_OUT_OF_MEMORY;
+    } catch (...) {
+        return RODUN_INTERNAL_ERROR;
+    }
+}
+
+const CutPlan* planAt(const rodun_job* job, size_t dimension) {
+    return job && dimension < job->plans.size() ? &job->plans[dimension] : nullptr;
+}
+
+} // namespace
+
+extern "C" {
+
+void rodun_options_init(rodun_options* options) {
+    if (!options) return;
+    options->algorithm = RODUN_PORTFOLIO;
+    options->time_limit_seconds = 10.0;
+    options->seed = 1;
+}
+
+rodun_job* rodun_job_create(void) {
+    return new (std::nothrow) rodun_job;
+}
+
+void rodun_job_free(rodun_job* job) {
+    delete job;
+}
+
+rodun_status rodun_job_set_stock(rodun_job* job, const char* dimension, rodun_length length) {
+    if (!job || !dimension || length <= 0) return RODUN_INVALID_ARGUMENT;
+    try {
+        job->stockLengths[dimension] = length;
+    } catch (...) {
+        return currentErrorStatus();
+    }
+    return RODUN_OK;
+}
+
+rodun_status rodun_job_add_demand(rodun_job* job, const char* dimension, rodun_length length, long long quantity,
+                                  const char* part_number) {
+    if (!job || !dimension || length <= 0 || quantity <= 0 || quantity > INT_MAX) return RODUN_INVALID_ARGUMENT;
+    try {
+        job->parts.push_back({ part_number ? part_number : "", length, static_cast<int>(quantity), dimension });
+    } catch (...) {
+        return currentErrorStatus();
+    }
+    return RODUN_OK;
+}
+
+rodun_status rodun_job_solve(rodun_job* job, const rodun_options* options) {
+    if (!job) return RODUN_INVALID_ARGUMENT;
+    rodun_options defaults;
+    rodun_options_init(&defaults);
+    if (!options) options = &defaults;
+    if (options->algorithm < RODUN_FIRST_FIT_DECREASING || options->algorithm > RODUN_VALUE_CORRECTION ||
+        !(options->time_limit_seconds > 0) || !std::isfinite(options->time_limit_seconds)) {
+        return RODUN_INVALID_ARGUMENT;
+    }
+
+    try {
+        job->dimensions.clear();
+        job->plans.clear();
+        std::unordered_map<std::string, std::vector<Part>> partsByDimension;
+        std::unordered_map<std::string, Length> stockLengths;
+        for (const auto& part : job->parts) {
+            partsByDimension[part.dimension].push_back(part);
+            auto stock = job->stockLengths.find(part.dimension);
+            stockLengths[part.dimension] = stock != job->stockLengths.end() ? stock->second : kDefaultStockLength;
+        }
+        if (partsByDimension.empty()) return RODUN_OK;
+
+        OptimizeOptions solve{ static_cast<Algorithm>(options->algorithm), options->time_limit_seconds };
+        solve.seed = options->seed;
+        solve.searchThreads = 0;
+        Portfolio run(sharedPool(), partsByDimension, stockLengths, solve);
+        run.wait();
+        auto plans = run.results();
+        // Every dimension starts from a first-fit plan, so nothing can be missing
+        if (plans.size() != partsByDimension.size()) return RODUN_INTERNAL_ERROR;
+
+        for (const auto& entry : plans) job->dimensions.push_back(entry.first);
+        std::ranges::sort(job->dimensions);
+        for (const auto& dim : job->dimensions) job->plans.push_back(std::move(plans.at(dim)));
+    } catch (...) {
+        job->dimensions.clear();
+        job->plans.clear();
+        return currentErrorStatus();
+    }
+    return RODUN_OK;
+}
+
+size_t rodun_job_dimension_count(const rodun_job* job) {
+    return job ? job->plans.size() : 0;
+}
+
+const char* rodun_job_dimension_name(const rodun_job* job, size_t dimension) {
+    return planAt(job, dimension) ? job->dimensions[dimension].c_str() : nullptr;
+}
+
+rodun_length rodun_job_stock_length(const rodun_job* job, size_t dimension) {
+    if (!planAt(job, dimension)) return 0;
+    auto stock = job->stockLengths.find(job->dimensions[dimension]);
+    return stock != job->stockLengths.end() ? stock->second : kDefaultStockLength;
+}
+
+long long rodun_job_stock_count(const rodun_job* job, size_t dimension) {
+    const CutPlan* plan = planAt(job, dimension);
+    return plan ? plan->stockCount() : 0;
+}
+
+long long rodun_job_lower_bound(const rodun_job* job, size_t dimension) {
+    const CutPlan* plan = planAt(job, dimension);
+    return plan ? plan->lowerBound() : 0;
+}
+
+size_t rodun_job_pattern_count(const rodun_job* job, size_t dimension) {
+    const CutPlan* plan = planAt(job, dimension);
+    return plan ? plan->patterns().size() : 0;
+}
+
+rodun_status rodun_job_pattern(const rodun_job* job, size_t dimension, size_t pattern, rodun_pattern* out) {
+    if (!job || !out) return RODUN_INVALID_ARGUMENT;
+    const CutPlan* plan = planAt(job, dimension);
+    if (!plan) return job->plans.empty() ? RODUN_NOT_SOLVED : RODUN_INVALID_ARGUMENT;
+    if (pattern >= plan->patterns().size()) return RODUN_INVALID_ARGUMENT;
+    const CutPattern& p = plan->patterns()[pattern];
+    out->cuts = p.cuts.data();
+    out->cut_count = p.cuts.size();
+    out->count = p.count;
+    out->used = p.used();
+    return RODUN_OK;
+}
+
+rodun_status rodun_job_write_pdf(const rodun_job* job, const char* path) {
+    if (!job || !path) return RODUN_INVALID_ARGUMENT;
+    if (job->plans.empty()) return RODUN_NOT_SOLVED;
+    try {
+        // The PDF labels stocks in whole inches, like the app
+        std::unordered_map<std::string, CutPlan> results;
+        std::unordered_map<std::string, int> stockInches;
+        for (size_t i = 0; i < job->plans.size(); ++i) {
+            results[job->dimensions[i]] = job->plans[i];
+            stockInches[job->dimensions[i]] = static_cast<int>(lengthToInches(rodun_job_stock_length(job, i)) + 0.5);
+        }
+        if (!generatePDF(results, stockInches, job->parts, path)) return RODUN_IO_ERROR;
+    } catch (...) {
+        return currentErrorStatus();
+    }
+    return RODUN_OK;
+}
+
+} // extern "C"
@@ -0,0 +1,103 @@
+#ifndef RODUN_H
+#define RODUN_H
+
+/* C interface to the Rodun engine, for embedding it in another process.
+ *
+ * A job collects demand per dimension, is solved once or more, and is then
+ * read back plan by plan. Lengths are fixed-point integers in
+ * RODUN_UNITS_PER_INCH steps, the same representation the solvers use, so
+ * nothing is rounded on the way in or out. Functions never throw; those
+ * that can fail return a rodun_status. A job is not thread-safe, but
+ * different jobs may be used from different threads at once: solves share
+ * one worker pool that the library starts on first use. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RODUN_UNITS_PER_INCH 10000
+
+typedef int64_t rodun_length;
+
+typedef enum rodun_status {
+    RODUN_OK = 0,
+    RODUN_INVALID_ARGUMENT = 1,
+    RODUN_NOT_SOLVED = 2, /* the job has no plans to read yet */
+    RODUN_CANCELLED = 3, /* reserved; no call can cancel a solve yet */
+    RODUN_OUT_OF_MEMORY = 4,
+    RODUN_IO_ERROR = 5,
+    RODUN_INTERNAL_ERROR = 6, /* a bug; the job is left unsolved */
+} rodun_status;
+
+/* Same order as the C++ Algorithm enum. */
+typedef enum rodun_algorithm {
+    RODUN_FIRST_FIT_DECREASING = 0,
+    RODUN_BEST_FIT_DECREASING,
+    RODUN_COLUMN_GENERATION,
+    RODUN_ARC_FLOW,
+    RODUN_BRANCH_AND_BOUND,
+    RODUN_ANYTIME,
+    RODUN_PORTFOLIO,
+    RODUN_LOCAL_SEARCH,
+    RODUN_GENETIC,
+    RODUN_MIN_BIN_SLACK,
+    RODUN_VALUE_CORRECTION,
+} rodun_algorithm;
+
+typedef struct rodun_options {
+    rodun_algorithm algorithm;
+    double time_limit_seconds;
+    unsigned long long seed; /* for the randomized searches */
+} rodun_options;
+
+/* One distinct cutting pattern; cuts point into the job and stay valid
+ * until it is solved again or freed. */
+typedef struct rodun_pattern {
+    const rodun_length* cuts; /* longest first */
+    size_t cut_count;
+    long long count; /* stocks cut this way */
+    rodun_length used;
+} rodun_pattern;
+
+typedef struct rodun_job rodun_job;
+
+/* Portfolio with a ten second budget. */
+void rodun_options_init(rodun_options* options);
+
+/* NULL when out of memory. */
+rodun_job* rodun_job_create(void);
+void rodun_job_free(rodun_job* job);
+
+/* Stock length of a dimension; dimensions never set get 288 inches. */
+rodun_status rodun_job_set_stock(rodun_job* job, const char* dimension, rodun_length length);
+
+/* Adds quantity pieces of one length; part_number may be NULL. */
+rodun_status rodun_job_add_demand(rodun_job* job, const char* dimension, rodun_length length, long long quantity,
+                                  const char* part_number);
+
+/* Optimizes every dimension at once and blocks until done. options may be
+ * NULL for the defaults; otherwise time_limit_seconds must be positive and
+ * finite, even for the greedy algorithms that ignore it. */
+rodun_status rodun_job_solve(rodun_job* job, const rodun_options* options);
+
+/* Solved dimensions, sorted by name; 0 before a solve. */
+size_t rodun_job_dimension_count(const rodun_job* job);
+const char* rodun_job_dimension_name(const rodun_job* job, size_t dimension);
+rodun_length rodun_job_stock_length(const rodun_job* job, size_t dimension);
+long long rodun_job_stock_count(const rodun_job* job, size_t dimension);
+long long rodun_job_lower_bound(const rodun_job* job, size_t dimension); /* 0 if unknown */
+
+size_t rodun_job_pattern_count(const rodun_job* job, size_t dimension);
+rodun_status rodun_job_pattern(const rodun_job* job, size_t dimension, size_t pattern, rodun_pattern* out);
+
+/* Writes the solved plans as the app's PDF. */
+rodun_status rodun_job_write_pdf(const rodun_job* job, const char* path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RODUN_H */
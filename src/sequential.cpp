@@ -0,0 +1,210 @@
+#include "sequential.h"
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+constexpr double kEpsilon = 1e-9;
+
+// Depth-first search for the most valuable pattern: how many pieces of each
+// row to take, rows longest first and the most pieces first. A branch is
+// cut when neither taking every piece left nor filling the room left at
+// the best value per length left could beat the best pattern so far.
+class PatternSearch {
+public:
+    PatternSearch(const std::vector<Demand>& rows, Length stockLength)
+        : rows(rows), stockLength(stockLength), take(rows.size()), suffixValue(rows.size() + 1),
+          suffixDensity(rows.size() + 1) {}
+
+    // Pieces of each row in the best pattern for the counts left. Stops at
+    // a pattern worth `enough` or after maxNodes nodes.
+    const std::vector<long long>& run(const std::vector<long long>& counts, const std::vector<double>& values,
+                                      double enough, long long maxNodes) {
+        left = &counts;
+        worth = &values;
+        target = enough;
+        nodeLimit = maxNodes;
+        nodes = 0;
+        bestValue = 0;
+        best.assign(rows.size(), 0);
+        for (size_t i = rows.size(); i-- > 0;) {
+            bool open = counts[i] > 0;
+            suffixValue[i] = suffixValue[i + 1] + (open ? values[i] * counts[i] : 0.0);
+            suffixDensity[i] = std::max(suffixDensity[i + 1], open ? values[i] / rows[i].length : 0.0);
+        }
+        search(0, stockLength, 0.0);
+        return best;
+    }
+
+private:
+    bool stopped() const { return nodes >= nodeLimit || bestValue >= target - kEpsilon; }
+
+    void search(size_t row, Length room, double value) {
+        ++nodes;
+        if (value > bestValue + kEpsilon) {
+            bestValue = value;
+            best = take;
+        }
+        if (row == rows.size() || stopped()) return;
+        double bound = value + std::min(suffixValue[row], static_cast<double>(room) * suffixDensity[row]);
+        if (bound <= bestValue + kEpsilon) return;
+
+        Length len = rows[row].length;
+        long long most = std::min<long long>((*left)[row], room / len);
+        for (long long k = most; k >= 0 && !stopped(); --k) {
+            take[row] = k;
+            search(row + 1, room - k * len, value + static_cast<double>(k) * (*worth)[row]);
+        }
+        take[row] = 0;
+    }
+
+    const std::vector<Demand>& rows;
+    Length stockLength;
+    const std::vector<long long>* left = nullptr;
+    const std::vector<double>* worth = nullptr;
+    double target = 0;
+    long long nodeLimit = 0;
+    long long nodes = 0;
+    double bestValue = 0;
+    std::vector<long long> take;
+    std::vector<long long> best;
+    std::vector<double> suffixValue; // every piece left from this row on
+    std::vector<double> suffixDensity; // best value per length from this row on
+};
+
+// Splits off pieces longer than the stock, one stock each, and returns the
+// other rows longest first.
+std::vector<Demand> fittingRows(const std::vector<Demand>& demand, Length stockLength, CutPlan& oversize) {
+    std::vector<Demand> rows;
+    for (const auto& item : demand) {
+        if (item.count <= 0 || item.length <= 0) continue;
+        if (item.length > stockLength) {
+            oversize.add({ item.length }, item.count);
+        } else {
+            rows.push_back(item);
+        }
+    }
+    std::ranges::sort(rows, std::greater<>(), &Demand::length);
+    return rows;
+}
+
+// Copies of the pattern the counts left allow.
+long long repeats(const std::vector<long long>& pattern, const std::vector<long long>& counts) {
+    long long copies = -1;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        if (pattern[i] > 0 && (copies < 0 || counts[i] / pattern[i] < copies)) copies = counts[i] / pattern[i];
+    }
+    return std::max(copies, 0LL);
+}
+
+std::vector<Length> patternCuts(const std::vector<long long>& pattern, const std::vector<Demand>& rows) {
+    std::vector<Length> cuts;
+    for (size_t i = 0; i < rows.size(); ++i) cuts.insert(cuts.end(), pattern[i], rows[i].length);
+    return cuts;
+}
+
+} // namespace
+
+MinBinSlackResult solveMinBinSlack(const std::vector<Demand>& demand, Length stockLength,
+                                   const MinBinSlackOptions& options) {
+    MinBinSlackResult result;
+    SolveBudget budget(options.timeLimitSeconds, options.control);
+    std::vector<Demand> rows = fittingRows(demand, stockLength, result.plan);
+
+    std::vector<long long> counts;
+    std::vector<double> lengths;
+    long long total = 0;
+    for (const auto& row : rows) {
+        counts.push_back(row.count);
+        lengths.push_back(static_cast<double>(row.length));
+        total += row.count;
+    }
+
+    PatternSearch search(rows, stockLength);
+    long long placed = 0;
+    while (placed < total && !budget.exhausted()) {
+        const std::vector<long long>& pattern = search.run(counts, lengths, static_cast<double>(stockLength),
+                                                           options.maxNodesPerStock);
+        long long copies = repeats(pattern, counts);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            counts[i] -= copies * pattern[i];
+            placed += copies * pattern[i];
+        }
+        result.plan.add(patternCuts(pattern, rows), copies);
+        if (options.control && total > 0) options.control->reportProgress(static_cast<double>(placed) / total);
+    }
+    result.cancelled = budget.cancelled();
+    if (result.cancelled || placed == total) return result;
+
+    // Out of time: pack whatever is left first-fit decreasing
+    result.timedOut = true;
+    std::vector<Demand> leftover;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (counts[i] > 0) leftover.push_back({ rows[i].length, counts[i] });
+    }
+    CutPlan repaired = packDemand(leftover, stockLength);
+    for (const auto& pattern : repaired.patterns()) result.plan.add(pattern.cuts, pattern.count);
+    return result;
+}
+
+ValueCorrectionResult solveValueCorrection(const std::vector<Demand>& demand, Length stockLength,
+                                           const ValueCorrectionOptions& options) {
+    ValueCorrectionResult result;
+    SolveBudget budget(options.timeLimitSeconds, options.control);
+    CutPlan oversize;
+    std::vector<Demand> rows = fittingRows(demand, stockLength, oversize);
+    result.plan = oversize;
+    if (rows.empty()) return result;
+
+    std::vector<double> values;
+    for (const auto& row : rows) values.push_back(static_cast<double>(row.length));
+
+    PatternSearch search(rows, stockLength);
+    bool complete = false;
+    while (result.iterations < options.maxIterations && !budget.exhausted()) {
+        CutPlan plan = oversize;
+        std::vector<long long> counts;
+        for (const auto& row : rows) counts.push_back(row.count);
+
+        bool stopped = false;
+        long long remaining = 0;
+        for (long long count : counts) remaining += count;
+        while (remaining > 0) {
+            // Checked per pattern: one iteration can take a while on big demands
+            if (budget.exhausted()) {
+                stopped = true;
+                break;
+            }
+            const std::vector<long long>& pattern = search.run(counts, values, 1e300, options.maxNodesPerPattern);
+            long long copies = repeats(pattern, counts);
+            Length used = 0;
+            for (size_t i = 0; i < rows.size(); ++i) used += pattern[i] * rows[i].length;
+
+            // Pieces this stock wastes more on are worth more next time
+            for (size_t i = 0; i < rows.size(); ++i) {
+                if (pattern[i] == 0) continue;
+                double estimate = static_cast<double>(rows[i].length) * stockLength / used;
+                double share = static_cast<double>(copies * pattern[i]) / rows[i].count;
+                values[i] += share * (estimate - values[i]);
+                counts[i] -= copies * pattern[i];
+                remaining -= copies * pattern[i];
+            }
+            plan.add(patternCuts(pattern, rows), copies);
+        }
+        if (stopped) break;
+
+        ++result.iterations;
+        if (!complete || plan.stockCount() < result.plan.stockCount()) result.plan = std::move(plan);
+        complete = true;
+        budget.reportProgress();
+        if (result.plan.stockCount() <= options.lowerBound) break;
+    }
+    result.timedOut = budget.timedOut();
+    result.cancelled = budget.cancelled();
+    if (complete) return result;
+
+    // Stopped inside the first iteration: fall back to first-fit decreasing
+    // unless cancelled, so a timed-out solve still covers the demand
+    if (!result.cancelled) result.plan = packDemand(demand, stockLength);
+    return result;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include "optimizer.h"
+#include "plan.h"
+#include "solve_control.h"
+
+struct MinBinSlackOptions {
+    double timeLimitSeconds = 10.0;
+    long long maxNodesPerStock = 100000; // search nodes spent filling one stock
+    SolveControl* control = nullptr;
+};
+
+struct MinBinSlackResult {
+    CutPlan plan;
+    bool timedOut = false; // the rest was packed first-fit decreasing
+    bool cancelled = false; // the plan is incomplete
+};
+
+// Gupta and Ho's Minimum Bin Slack. Stocks are filled one at a time, each
+// with the set of remaining pieces that leaves the least unused length, as
+// far as a depth-first search over piece counts finds within its node
+// limit; a pattern with no slack ends the search at once. The pattern is
+// cut as many times as the demand allows, since with fewer pieces left the
+// search would only find it again.
+MinBinSlackResult solveMinBinSlack(const std::vector<Demand>& demand, Length stockLength,
+                                   const MinBinSlackOptions& options = {});
+
+struct ValueCorrectionOptions {
+    double timeLimitSeconds = 10.0;
+    int maxIterations = 50; // complete plans built
+    long long maxNodesPerPattern = 20000;
+    long long lowerBound = 0; // stop once a plan uses this few stocks
+    SolveControl* control = nullptr;
+};
+
+struct ValueCorrectionResult {
+    CutPlan plan; // fewest stocks over all iterations
+    int iterations = 0;
+    bool timedOut = false;
+    bool cancelled = false; // the plan is the best complete one so far
+};
+
+// Sequential Value Correction. Each iteration builds a whole plan one
+// pattern at a time, taking the pattern of greatest total piece value (a
+// bounded knapsack searched depth first) as often as the demand allows.
+// Pieces start valued at their length; after each pattern the value of
+// its pieces moves towards length * stock / used length, weighted by the
+// share of their demand it covered, so pieces that only fit in wasteful
+// stocks are placed earlier next time.
+ValueCorrectionResult solveValueCorrection(const std::vector<Demand>& demand, Length stockLength,
+                                           const ValueCorrectionOptions& options = {});
@@ -0,0 +1,320 @@
+#include "server.h"
+#include <cstdio>
+
+#ifdef _WIN32
+
+int runServer(const ServerOptions&) {
+    std::fprintf(stderr, "serve needs Unix domain sockets, which this build does not support\n");
+    return 1;
+}
+
+#else
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <exception>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "job.h"
+#include "pdf_export.h"
+#include "thread_pool.h"
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void onStopSignal(int) {
+    stopRequested = 1;
+}
+
+bool readAll(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t got = read(fd, data, size);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        data += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+bool readFrame(int fd, std::string& payload) {
+    unsigned char header[4];
+    if (!readAll(fd, reinterpret_cast<char*>(header), sizeof(header))) return false;
+    uint32_t size = uint32_t{ header[0] } << 24 | uint32_t{ header[1] } << 16 | uint32_t{ header[2] } << 8 | header[3];
+    if (size > kMaxFrameBytes) return false;
+    payload.resize(size);
+    return readAll(fd, payload.data(), size);
+}
+
+// Header, tag and body in one gathered write, so a PDF is never copied.
+bool writeFrame(int fd, char tag, const std::string& body) {
+    uint32_t size = static_cast<uint32_t>(body.size() + 1);
+    unsigned char header[5] = { static_cast<unsigned char>(size >> 24), static_cast<unsigned char>(size >> 16),
+                                static_cast<unsigned char>(size >> 8), static_cast<unsigned char>(size),
+                                static_cast<unsigned char>(tag) };
+    iovec parts[2] = { { header, sizeof(header) }, { const_cast<char*>(body.data()), body.size() } };
+    size_t left = sizeof(header) + body.size();
+    int first = 0;
+    while (left > 0) {
+        ssize_t sent = writev(fd, parts + first, 2 - first);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        left -= static_cast<size_t>(sent);
+        for (size_t done = static_cast<size_t>(sent); done > 0 && first < 2;) {
+            size_t step = std::min(done, parts[first].iov_len);
+            parts[first].iov_base = static_cast<char*>(parts[first].iov_base) + step;
+            parts[first].iov_len -= step;
+            done -= step;
+            if (parts[first].iov_len == 0) ++first;
+        }
+    }
+    return true;
+}
+
+struct Response {
+    std::vector<std::pair<char, std::string>> frames;
+    bool failed = false; // not worth caching
+};
+
+// The most recent responses by request bytes, least recently used out first.
+class ResponseCache {
+public:
+    explicit ResponseCache(size_t capacity) : capacity(capacity) {}
+
+    std::shared_ptr<const Response> find(const std::string& request) {
+        std::lock_guard lock(mutex);
+        auto it = index.find(request);
+        if (it == index.end()) return nullptr;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->second;
+    }
+
+    void insert(const std::string& request, std::shared_ptr<const Response> response) {
+        if (capacity == 0) return;
+        std::lock_guard lock(mutex);
+        if (index.contains(request)) return;
+        entries.emplace_front(request, std::move(response));
+        index[request] = entries.begin();
+        if (entries.size() > capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<const Response>>;
+
+    size_t capacity;
+    std::mutex mutex;
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+};
+
+Response failure(const std::string& message) {
+    Response response;
+    response.frames.emplace_back(kFrameError, message);
+    response.failed = true;
+    return response;
+}
+
+Response answer(const std::string& request, ThreadPool& pool) {
+    if (request.empty()) return failure("empty request");
+
+    auto started = std::chrono::steady_clock::now();
+    auto flags = static_cast<uint8_t>(request[0]);
+    Job job;
+    std::string error;
+    if (!readJobText(request.substr(1), "request", job, error)) return failure(error);
+    std::unordered_map<std::string, CutPlan> plans = solveJob(job, pool);
+    if (plans.empty() && !job.parts.empty()) return failure("no complete plan");
+
+    long long stocks = 0;
+    long long bound = 0;
+    for (const auto& [dim, plan] : plans) {
+        stocks += plan.stockCount();
+        bound += plan.lowerBound();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    char summary[96];
+    std::snprintf(summary, sizeof(summary), "stocks %lld lower-bound %lld seconds %.3f", stocks, bound, seconds);
+    Response response;
+    response.frames.emplace_back(kFrameSummary, summary);
+
+    if (flags & kWantPlan) response.frames.emplace_back(kFramePlan, formatPlanTable(plans, job.stockLengths));
+    if (flags & kWantPdf) {
+        std::string pdf = renderPDF(plans, job.stockLengths, job.parts);
+        if (pdf.empty()) return failure("PDF rendering failed");
+        response.frames.emplace_back(kFramePdf, std::move(pdf));
+    }
+    return response;
+}
+
+// Open client sockets, so a stopping server can unblock their readers.
+class Connections {
+public:
+    void add(int fd) {
+        std::lock_guard lock(mutex);
+        open.insert(fd);
+    }
+
+    void close(int fd) {
+        std::lock_guard lock(mutex);
+        open.erase(fd);
+        ::close(fd);
+    }
+
+    void shutdownAll() {
+        std::lock_guard lock(mutex);
+        for (int fd : open) shutdown(fd, SHUT_RDWR);
+    }
+
+private:
+    std::mutex mutex;
+    std::unordered_set<int> open;
+};
+
+void serveConnection(int fd, ThreadPool& pool, ResponseCache& cache, Connections& connections) {
+    std::string request;
+    while (readFrame(fd, request)) {
+        std::shared_ptr<const Response> response = cache.find(request);
+        if (!response) {
+            // A failed solve answers this request, not the whole connection
+            std::shared_ptr<Response> fresh;
+            try {
+                fresh = std::make_shared<Response>(answer(request, pool));
+            } catch (const std::exception& error) {
+                fresh = std::make_shared<Response>(failure(error.what()));
+            } catch (...) {
+                fresh = std::make_shared<Response>(failure("internal error"));
+            }
+            if (!fresh->failed) cache.insert(request, fresh);
+            response = std::move(fresh);
+        }
+        bool sent = true;
+        for (const auto& [tag, body] : response->frames) {
+            if (!(sent = writeFrame(fd, tag, body))) break;
+        }
+        if (!sent || !writeFrame(fd, kFrameEnd, {})) break;
+    }
+    connections.close(fd);
+}
+
+struct Client {
+    std::thread thread;
+    std::shared_ptr<std::atomic<bool>> done;
+};
+
+// Clears the way for bind: a socket nobody answers on is stale and goes,
+// while a live server or a file that is not a socket stays and is an error.
+bool claimSocketPath(const std::string& path, const sockaddr_un& address) {
+    struct stat info;
+    if (lstat(path.c_str(), &info) < 0) {
+        if (errno == ENOENT) return true;
+        std::perror(path.c_str());
+        return false;
+    }
+    if (!S_ISSOCK(info.st_mode)) {
+        std::fprintf(stderr, "%s: exists and is not a socket\n", path.c_str());
+        return false;
+    }
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe < 0) {
+        std::perror("socket");
+        return false;
+    }
+    bool live = connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    close(probe);
+    if (live) {
+        std::fprintf(stderr, "%s: another server is listening\n", path.c_str());
+        return false;
+    }
+    unlink(path.c_str());
+    return true;
+}
+
+} // namespace
+
+int runServer(const ServerOptions& options) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.empty() || options.socketPath.size() >= sizeof(address.sun_path)) {
+        std::fprintf(stderr, "%s: socket path too long\n", options.socketPath.c_str());
+        return 1;
+    }
+    std::memcpy(address.sun_path, options.socketPath.c_str(), options.socketPath.size() + 1);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::perror("socket");
+        return 1;
+    }
+    if (!claimSocketPath(options.socketPath, address)) {
+        close(listener);
+        return 1;
+    }
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listener, 64) < 0) {
+        std::perror(options.socketPath.c_str());
+        close(listener);
+        return 1;
+    }
+
+    // A client that hangs up mid-response must not kill the server
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+
+    // Started once; every request after the first finds the workers waiting
+    ThreadPool pool(options.threads);
+    ResponseCache cache(options.cacheEntries);
+    Connections connections;
+    std::vector<Client> clients;
+    std::fprintf(stderr, "listening on %s with %u workers\n", options.socketPath.c_str(), pool.size());
+
+    while (!stopRequested) {
+        // Wake now and then to notice a stop request and reap finished
+        // clients; at the connection limit, new ones wait in the backlog
+        pollfd ready{ listener, POLLIN, 0 };
+        int events = poll(&ready, clients.size() < options.maxConnections ? 1 : 0, 200);
+        std::erase_if(clients, [](Client& client) {
+            if (!client.done->load()) return false;
+            client.thread.join();
+            return true;
+        });
+        if (events <= 0) continue;
+
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) continue;
+        connections.add(fd);
+        auto done = std::make_shared<std::atomic<bool>>(false);
+        clients.push_back({ std::thread([fd, done, &pool, &cache, &connections] {
+                               serveConnection(fd, pool, cache, connections);
+                               done->store(true);
+                           }),
+                            done });
+    }
+
+    close(listener);
+    unlink(options.socketPath.c_str());
+    connections.shutdownAll();
+    for (auto& client : clients) client.thread.join();
+    return 0;
+}
+
+#endif
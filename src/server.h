@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Wire format of `Rodun serve`. Every message in either direction is a
+// frame: the payload length as 4 bytes, most significant first, then the
+// payload. A request is one frame holding a flags byte followed by the text
+// of a job file (see job.h). The server answers with frames whose first
+// byte tags the rest, always ending with kFrameEnd, and then reads the next
+// request on the same connection:
+//
+//     'S' summary, "stocks 12 lower-bound 11 seconds 0.042"
+//     'P' the plan table, as formatPlanTable writes it (if kWantPlan)
+//     'D' the PDF bytes (if kWantPdf)
+//     'E' an error message; no plan or PDF follows
+//     'Z' end of the response, no payload
+constexpr uint8_t kWantPlan = 1;
+constexpr uint8_t kWantPdf = 2;
+
+constexpr char kFrameSummary = 'S';
+constexpr char kFramePlan = 'P';
+constexpr char kFramePdf = 'D';
+constexpr char kFrameError = 'E';
+constexpr char kFrameEnd = 'Z';
+
+constexpr uint32_t kMaxFrameBytes = 256u << 20;
+
+struct ServerOptions {
+    std::string socketPath = "/tmp/rodun.sock";
+    unsigned threads = 0; // solver workers; 0 = one per core
+    size_t cacheEntries = 64; // responses kept for repeated requests
+    size_t maxConnections = 64; // served at once; more wait to be accepted
+};
+
+// Listens on a Unix domain socket and serves jobs until SIGINT or SIGTERM.
+// One thread per connection reads requests; every solve runs on one pool
+// of workers started with the server, and identical requests are answered
+// from a cache of recent responses. A socket left at the path by a server
+// that did not stop cleanly is replaced; anything else there, or a server
+// still answering on it, is an error. Returns the process exit code.
+int runServer(const ServerOptions& options);
@@ -0,0 +1,51 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+// Shared between a running solve and whoever started it. The solver polls
+// cancelled() at safe points and reports how far along it is; the caller
+// may cancel at any time and reads progress from another thread.
+class SolveControl {
+public:
+    void cancel() { cancelRequested.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return cancelRequested.load(std::memory_order_relaxed); }
+
+    // Fraction done in [0, 1]; never moves backwards.
+    void reportProgress(double fraction) {
+        fraction = std::clamp(fraction, 0.0, 1.0);
+        double current = done.load(std::memory_order_relaxed);
+        while (fraction > current && !done.compare_exchange_weak(current, fraction, std::memory_order_relaxed)) {
+        }
+    }
+    double progress() const { return done.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> cancelRequested{ false };
+    std::atomic<double> done{ 0.0 };
+};
+
+// Wall-clock budget for one iterative solve, which also carries the
+// caller's cancellation and reports progress as the share of time spent.
+class SolveBudget {
+public:
+    SolveBudget(double seconds, SolveControl* control)
+        : start(std::chrono::steady_clock::now()), limit(std::max(seconds, 0.0)), control(control) {}
+
+    bool cancelled() const { return control && control->cancelled(); }
+    bool timedOut() const { return elapsed() >= limit; }
+    bool exhausted() const { return cancelled() || timedOut(); }
+
+    void reportProgress() const {
+        if (control && limit > 0) control->reportProgress(std::min(0.99, elapsed() / limit));
+    }
+
+    double elapsed() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+    double limit;
+    SolveControl* control;
+};
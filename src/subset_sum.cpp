@@ -0,0 +1,120 @@
+#include "subset_sum.h"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+// Bitset words times chunks all takeTightPatterns rounds together may cost
+constexpr long long kTightPatternWork = 1 << 28;
+
+template <typename Visit>
+void forEachChunk(const std::vector<long long>& weights, const std::vector<long long>& copies, long long capacity,
+                  Visit visit) {
+    for (size_t i = 0; i < weights.size(); ++i) {
+        if (weights[i] <= 0 || weights[i] > capacity) continue;
+        long long left = std::min(copies[i], capacity / weights[i]);
+        for (long long k = 1; left > 0; k *= 2) {
+            long long take = std::min(k, left);
+            visit(static_cast<int>(i), take, take * weights[i]);
+            left -= take;
+        }
+    }
+}
+
+} // namespace
+
+SubsetSum::SubsetSum(const std::vector<long long>& weights, const std::vector<long long>& copies, long long capacity)
+    : capacity(capacity), itemCount(weights.size()) {
+    size_t words = static_cast<size_t>(capacity / 64 + 1);
+    reach.assign(words, 0);
+    reach[0] = 1;
+    firstChunk.assign(static_cast<size_t>(capacity) + 1, -1);
+    uint64_t lastMask = (capacity + 1) % 64 ? (uint64_t(1) << ((capacity + 1) % 64)) - 1 : ~uint64_t(0);
+
+    forEachChunk(weights, copies, capacity, [&](int item, long long take, long long weight) {
+        int index = static_cast<int>(chunks.size());
+        chunks.push_back({ item, take, weight });
+        size_t wordShift = static_cast<size_t>(weight / 64);
+        unsigned bitShift = static_cast<unsigned>(weight % 64);
+        // High words first, so every source word is read before it changes
+        for (size_t i = words; i-- > wordShift;) {
+            uint64_t moved = reach[i - wordShift] << bitShift;
+            if (bitShift && i > wordShift) moved |= reach[i - wordShift - 1] >> (64 - bitShift);
+            if (i == words - 1) moved &= lastMask;
+            uint64_t fresh = moved & ~reach[i];
+            reach[i] |= moved;
+            for (; fresh; fresh &= fresh - 1) firstChunk[i * 64 + __builtin_ctzll(fresh)] = index;
+        }
+    });
+}
+
+long long SubsetSum::work(const std::vector<long long>& weights, const std::vector<long long>& copies,
+                          long long capacity) {
+    long long chunkCount = 0;
+    forEachChunk(weights, copies, capacity, [&](int, long long, long long) { ++chunkCount; });
+    return (capacity / 64 + 1) * chunkCount;
+}
+
+bool SubsetSum::reachable(long long total) const {
+    return total >= 0 && total <= capacity && (reach[total / 64] >> (total % 64) & 1);
+}
+
+long long SubsetSum::best(long long limit) const {
+    limit = std::min(limit, capacity);
+    if (limit < 0) return 0;
+    size_t word = static_cast<size_t>(limit / 64);
+    uint64_t bits = reach[word];
+    if (limit % 64 != 63) bits &= (uint64_t(2) << (limit % 64)) - 1;
+    while (bits == 0) bits = reach[--word];
+    return static_cast<long long>(word) * 64 + 63 - __builtin_clzll(bits);
+}
+
+std::vector<long long> SubsetSum::combination(long long total) const {
+    std::vector<long long> counts(itemCount, 0);
+    while (total > 0) {
+        const Chunk& chunk = chunks[firstChunk[total]];
+        counts[chunk.item] += chunk.copies;
+        total -= chunk.weight;
+    }
+    return counts;
+}
+
+CutPlan takeTightPatterns(std::vector<Demand>& demand, Length stockLength, Length tolerance) {
+    CutPlan plan;
+    long long grid = stockLength;
+    for (const auto& item : demand) {
+        if (item.count > 0 && item.length > 0 && item.length <= stockLength) grid = std::gcd(grid, item.length);
+    }
+    long long capacity = stockLength / grid;
+    long long lowest = (stockLength - tolerance + grid - 1) / grid; // fewest grid steps a tight pattern uses
+
+    long long budget = kTightPatternWork;
+    while (true) {
+        std::vector<long long> weights, copies;
+        for (const auto& item : demand) {
+            bool usable = item.count > 0 && item.length > 0 && item.length <= stockLength;
+            weights.push_back(usable ? item.length / grid : 0);
+            copies.push_back(usable ? item.count : 0);
+        }
+        budget -= SubsetSum::work(weights, copies, capacity);
+        if (budget < 0) break;
+
+        SubsetSum sums(weights, copies, capacity);
+        long long total = sums.best(capacity);
+        if (total < lowest || total == 0) break;
+
+        std::vector<long long> pieces = sums.combination(total);
+        long long stocks = -1;
+        std::vector<Length> cuts;
+        for (size_t i = 0; i < demand.size(); ++i) {
+            if (pieces[i] == 0) continue;
+            long long fits = demand[i].count / pieces[i];
+            stocks = stocks < 0 ? fits : std::min(stocks, fits);
+            cuts.insert(cuts.end(), pieces[i], demand[i].length);
+        }
+        std::ranges::sort(cuts, std::greater<>());
+        for (size_t i = 0; i < demand.size(); ++i) demand[i].count -= stocks * pieces[i];
+        plan.add(std::move(cuts), stocks);
+    }
+    return plan;
+}
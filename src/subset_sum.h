@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "optimizer.h"
+#include "plan.h"
+
+// Word-parallel subset sum: which totals 0..capacity some multiset of the
+// items reaches, each item used at most its number of copies. Items are
+// split into power-of-two chunks and each chunk is one shift-or over the
+// reachability bitset. Every total remembers the chunk that first reached
+// it, which is all the back-pointer a combination needs.
+class SubsetSum {
+public:
+    SubsetSum(const std::vector<long long>& weights, const std::vector<long long>& copies, long long capacity);
+
+    // Bitset words times chunks a run would take, to check it is affordable.
+    static long long work(const std::vector<long long>& weights, const std::vector<long long>& copies,
+                          long long capacity);
+
+    bool reachable(long long total) const;
+
+    // Largest reachable total no greater than limit (0 is always reachable).
+    long long best(long long limit) const;
+
+    // Copies of each item in one combination summing to a reachable total.
+    std::vector<long long> combination(long long total) const;
+
+private:
+    struct Chunk {
+        int item;
+        long long copies;
+        long long weight;
+    };
+
+    long long capacity;
+    size_t itemCount;
+    std::vector<Chunk> chunks;
+    std::vector<uint64_t> reach;
+    std::vector<int> firstChunk; // per total, the chunk that first reached it
+};
+
+// Cuts the pattern with the least waste over and over, as many stocks at a
+// time as the demand allows, while it leaves at most `tolerance` of the
+// stock unused. Earlier items in `demand` are preferred, so pass it longest
+// first. Returns those stocks and leaves the rest of the demand in place;
+// returns nothing if the length grid is too fine to search cheaply.
+CutPlan takeTightPatterns(std::vector<Demand>& demand, Length stockLength, Length tolerance);
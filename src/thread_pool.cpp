@@ -0,0 +1,92 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <exception>
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; ++i)
+        workers.emplace_back([this] { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return; // stopping, and nothing left to run
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    // Shared with the queued tasks, which may run after this returns and
+    // then find every index taken
+    struct Claims {
+        std::mutex mutex;
+        std::condition_variable idle;
+        std::vector<bool> taken;
+        size_t running = 0; // started by a worker and not yet returned
+        std::exception_ptr error;
+    };
+    auto claims = std::make_shared<Claims>();
+    claims->taken.assign(count, false);
+    auto claim = [](Claims& claims, size_t index) {
+        if (claims.taken[index]) return false;
+        claims.taken[index] = true;
+        return true;
+    };
+
+    for (size_t i = 1; i < count; ++i) {
+        submit([claims, claim, i, &fn] {
+            {
+                std::lock_guard lock(claims->mutex);
+                if (!claim(*claims, i)) return;
+                ++claims->running;
+            }
+            std::exception_ptr error;
+            try {
+                fn(i);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard lock(claims->mutex);
+            if (error && !claims->error) claims->error = error;
+            --claims->running;
+            claims->idle.notify_all();
+        });
+    }
+
+    std::exception_ptr error;
+    try {
+        for (size_t i = 0; i < count; ++i) {
+            bool mine;
+            {
+                std::lock_guard lock(claims->mutex);
+                mine = claim(*claims, i);
+            }
+            if (mine) fn(i);
+        }
+    } catch (...) {
+        error = std::current_exception();
+        std::lock_guard lock(claims->mutex);
+        std::fill(claims->taken.begin(), claims->taken.end(), true);
+    }
+
+    std::unique_lock lock(claims->mutex);
+    claims->idle.wait(lock, [&claims] { return claims->running == 0; });
+    if (!error) error = claims->error;
+    if (error) std::rethrow_exception(error);
+}